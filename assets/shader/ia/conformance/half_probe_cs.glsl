@@ -0,0 +1,9 @@
+layout (local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+
+layout (binding = CURR_IMG_BIND, CONTINUOUS_STATE) writeonly uniform image2D current_image;
+
+// 1 + 0.75 half ULP, nearest rounding stores 1 + 1 ULP and toward zero stores 1
+void main() 
+{
+  imageStore(current_image, ivec2(0), vec4(1.0 + 0.75 / 1024.0));
+}
@@ -1,16 +1,16 @@
 layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = Z_THREADS) in;
 
-layout (binding = CURR_IMG_BIND, rgba8) writeonly uniform image2D current_image;
-layout (binding = PREV_IMG_BIND, rgba8) readonly uniform image2D prev_image;
+layout (binding = CURR_IMG_BIND, BINARY_STATE) writeonly uniform image2D current_image;
+layout (binding = PREV_IMG_BIND, BINARY_STATE) readonly uniform image2D prev_image;
 
 void main() 
 {
-  // Obtener el color previo
   ivec2 texelCoord = ivec2(gl_GlobalInvocationID.xy);
-  vec4 currentColor = imageLoad(prev_image, texelCoord);
+  if (texelCoord.x >= C_WIDTH || texelCoord.y >= C_HEIGHT)
+    return;
 
-  // Obtener el componente alpha del pixel actual
-  float alpha = currentColor.a;
+  // Obtener el estado de la celda actual
+  float alpha = imageLoad(prev_image, texelCoord).r;
 
   // Definir las reglas del Juego de la Vida de Conway
   float numAliveNeighbors = 0;
@@ -19,15 +19,14 @@ void main()
   {
     for (int j = -1; j <= 1; j++) 
     {
-      ivec2 neighborCoord = texelCoord + ivec2(i, j);
-      vec4 neighborColor = imageLoad(prev_image, neighborCoord);
+      ivec2 neighborCoord = ivec2(WRAP(texelCoord.x + i, C_WIDTH), WRAP(texelCoord.y + j, C_HEIGHT));
 
-      // Sumar el componente alpha del vecino actual si está vivo
-      numAliveNeighbors += neighborColor.a;
+      // Sumar el estado del vecino actual si está vivo
+      numAliveNeighbors += imageLoad(prev_image, neighborCoord).r;
     }
   }
 
-  // Restar el propio componente alpha si está vivo
+  // Restar el propio estado si está vivo
   numAliveNeighbors -= alpha;
 
   // Aplicar las reglas del Juego de la Vida
@@ -49,9 +48,6 @@ void main()
     }
   }
 
-  // Mantener el color previo y actualizar el componente alpha
-  vec4 updatedColor = vec4(currentColor.rgb, alpha);
-
-  // Escribir el color actualizado en la imagen actual
-  imageStore(current_image, texelCoord, updatedColor);
+  // Escribir el estado actualizado en la imagen actual
+  imageStore(current_image, texelCoord, vec4(alpha));
 }
\ No newline at end of file
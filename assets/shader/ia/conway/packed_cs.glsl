@@ -0,0 +1,70 @@
+layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = Z_THREADS) in;
+
+// 32 cells per word, bit i of a word is the column word * 32 + i
+#define ROW_WORDS ((C_WIDTH + 31) / 32)
+// Columns in the last word of a row, the bits past them stay 0
+#define LAST_BITS (C_WIDTH - (ROW_WORDS - 1) * 32)
+#define LAST_MASK (0xffffffffu >> (32 - LAST_BITS))
+
+layout (binding = PACKED_PREV_BIND, std430) readonly buffer PrevCells { uint prev_cells_[]; };
+layout (binding = PACKED_CURR_BIND, std430) writeonly buffer CurrCells { uint curr_cells_[]; };
+
+uint Cells(int word, int row)
+{
+  return prev_cells_[row * ROW_WORDS + word];
+}
+
+// West (x - 1) and east (x + 1) neighbours of the 32 cells moved onto their bits, wrapping at the row ends
+void Neighbours(int word, int row, uint center, out uint west, out uint east)
+{
+  uint west_bit = (word == 0) ? (Cells(ROW_WORDS - 1, row) >> (LAST_BITS - 1)) & 1u : Cells(word - 1, row) >> 31;
+  uint east_bit = Cells((word == ROW_WORDS - 1) ? 0 : word + 1, row) & 1u;
+
+  west = (center << 1) | west_bit;
+  east = (center >> 1) | (east_bit << ((word == ROW_WORDS - 1) ? LAST_BITS - 1 : 31));
+}
+
+void main()
+{
+  int word = int(gl_GlobalInvocationID.x);
+  int row = int(gl_GlobalInvocationID.y);
+  if (word >= ROW_WORDS || row >= C_HEIGHT)
+    return;
+
+  int up = WRAP(row - 1, C_HEIGHT);
+  int down = WRAP(row + 1, C_HEIGHT);
+
+  uint alive = Cells(word, row);
+  uint up_center = Cells(word, up);
+  uint down_center = Cells(word, down);
+
+  uint west, east, up_west, up_east, down_west, down_east;
+  Neighbours(word, row, alive, west, east);
+  Neighbours(word, up, up_center, up_west, up_east);
+  Neighbours(word, down, down_center, down_west, down_east);
+
+  // Every bit adds its own 8 neighbours, full adders for the rows above and below
+  // and a half adder for its row, the cell itself isn't a neighbour
+  uint up_ones = up_west ^ up_center ^ up_east;
+  uint up_twos = (up_west & up_center) | (up_east & (up_west ^ up_center));
+  uint down_ones = down_west ^ down_center ^ down_east;
+  uint down_twos = (down_west & down_center) | (down_east & (down_west ^ down_center));
+  uint ones = west ^ east;
+  uint twos = west & east;
+
+  // Weight one bit of the sum and its carry
+  uint sum_ones = up_ones ^ ones ^ down_ones;
+  uint carry = (up_ones & ones) | (down_ones & (up_ones ^ ones));
+
+  // The sum is 2 or 3 when exactly one of the four weight two inputs is set
+  uint sum_twos = up_twos ^ twos ^ down_twos;
+  uint sum_fours = (up_twos & twos) | (down_twos & (up_twos ^ twos));
+  uint two_or_three = ~sum_fours & (sum_twos ^ carry);
+
+  // 3 gives birth, 2 keeps the alive ones
+  uint next = two_or_three & (sum_ones | alive);
+  if (word == ROW_WORDS - 1)
+    next &= LAST_MASK;
+
+  curr_cells_[row * ROW_WORDS + word] = next;
+}
@@ -0,0 +1,27 @@
+layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = Z_THREADS) in;
+
+#define ROW_WORDS ((C_WIDTH + 31) / 32)
+
+layout (binding = PACKED_CURR_BIND, std430) readonly buffer CurrCells { uint curr_cells_[]; };
+layout (binding = CURR_IMG_BIND, BINARY_STATE) writeonly uniform image2D display_state;
+
+// One texel per DISPLAY_SCALE^2 block of cells, the alive fraction of it
+void main()
+{
+  ivec2 texelCoord = ivec2(gl_GlobalInvocationID.xy);
+  if (texelCoord.x >= D_WIDTH || texelCoord.y >= D_HEIGHT)
+    return;
+
+  ivec2 first = texelCoord * DISPLAY_SCALE;
+  ivec2 last = min(first + DISPLAY_SCALE, ivec2(C_WIDTH, C_HEIGHT));
+
+  uint alive = 0u;
+  for (int y = first.y; y < last.y; y++)
+  {
+    for (int x = first.x; x < last.x; x++)
+      alive += (curr_cells_[y * ROW_WORDS + x / 32] >> (x % 32)) & 1u;
+  }
+
+  ivec2 block = last - first;
+  imageStore(display_state, texelCoord, vec4(float(alive) / float(block.x * block.y)));
+}
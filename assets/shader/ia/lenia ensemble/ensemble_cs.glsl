@@ -0,0 +1,87 @@
+// LENIA_TILE, WORLD_WIDTH, WORLD_HEIGHT and WORLD_COLUMNS are injected when compiling
+// The workgroup z is the world, C_WIDTH & C_HEIGHT are the whole atlas
+layout (local_size_x = LENIA_TILE, local_size_y = LENIA_TILE, local_size_z = 1) in;
+
+layout (binding = CURR_IMG_BIND, CONTINUOUS_STATE) writeonly uniform image2D current_image;
+layout (binding = PREV_IMG_BIND, CONTINUOUS_STATE) readonly uniform image2D prev_image;
+
+// Normalized weights, (2 * automata_.extent_ + 1)^2 centered on the cell, shared by every world
+layout (binding = KERNEL_BIND, std430) readonly buffer KernelBlock { float kernel_[]; };
+
+struct WorldParams
+{
+  float mu_;
+  float sigma_;
+  float dt_;
+  float padding_;
+};
+
+layout (binding = ENSEMBLE_PARAMS_BIND, std430) readonly buffer ParamsBlock { WorldParams params_[]; };
+
+#define HALO_SIZE (LENIA_TILE + 2 * LENIA_MAX_RADIUS)
+
+shared float tile_[HALO_SIZE * HALO_SIZE];
+
+ivec2 WorldOrigin(int world)
+{
+  return ivec2(world % WORLD_COLUMNS, world / WORLD_COLUMNS) * ivec2(WORLD_WIDTH, WORLD_HEIGHT);
+}
+
+// The halo wraps inside the world, not the atlas
+void LoadTile(ivec2 world_origin, ivec2 origin, int side)
+{
+  int thread = int(gl_LocalInvocationIndex);
+  for (int i = thread; i < side * side; i += LENIA_TILE * LENIA_TILE)
+  {
+    ivec2 cell = origin + ivec2(i % side, i / side) - ivec2(automata_.extent_);
+    cell.x = WRAP(cell.x, WORLD_WIDTH);
+    cell.y = WRAP(cell.y, WORLD_HEIGHT);
+
+    tile_[i] = imageLoad(prev_image, world_origin + cell).r;
+  }
+}
+
+float Convolution(ivec2 local, int side)
+{
+  float sum = 0;
+  int kernel_side = TOTAL_COLUMNS(automata_.extent_);
+  for(int x = -automata_.extent_; x <= automata_.extent_; x++)
+  {
+    for(int y = -automata_.extent_; y <= automata_.extent_; y++)
+    {
+      float alpha = tile_[ARRAY_2D_INDEX((local.x + automata_.extent_ + x), (local.y + automata_.extent_ + y), side)];
+
+      float weight = kernel_[ARRAY_2D_INDEX((x + automata_.extent_), (y + automata_.extent_), kernel_side)];
+
+      sum += (alpha * weight);
+    }
+  }
+  return sum;
+}
+
+void main() 
+{
+  int world = int(gl_WorkGroupID.z);
+  ivec2 world_origin = WorldOrigin(world);
+  ivec2 cell = ivec2(gl_GlobalInvocationID.xy);
+  ivec2 local = ivec2(gl_LocalInvocationID.xy);
+  int side = LENIA_TILE + 2 * automata_.extent_;
+
+  LoadTile(world_origin, ivec2(gl_WorkGroupID.xy) * LENIA_TILE, side);
+  barrier();
+
+  if (cell.x >= WORLD_WIDTH || cell.y >= WORLD_HEIGHT)
+    return;
+
+  WorldParams params = params_[world];
+
+  float avg = Convolution(local, side);
+
+  float growth = (GaussBell(avg, params.mu_, params.sigma_) * 2.0) - 1.0;
+
+  float value = tile_[ARRAY_2D_INDEX((local.x + automata_.extent_), (local.y + automata_.extent_), side)];
+
+  float c = clamp(value + (1.0 / params.dt_) * growth, 0.0, 1.0);
+
+  imageStore(current_image, world_origin + cell, vec4(c));
+}
@@ -0,0 +1,42 @@
+// WORLD_WIDTH, WORLD_HEIGHT and WORLD_COLUMNS are injected when compiling, one workgroup per world
+layout (local_size_x = SCAN_THREADS, local_size_y = 1, local_size_z = 1) in;
+
+layout (binding = CURR_IMG_BIND, CONTINUOUS_STATE) readonly uniform image2D current_image;
+layout (binding = PREV_IMG_BIND, CONTINUOUS_STATE) readonly uniform image2D prev_image;
+
+// Mean, variance and mean change of the last generation
+layout (binding = ENSEMBLE_STATS_BIND, std430) writeonly buffer StatsBlock { vec4 stats_[]; };
+
+shared vec3 sums_[SCAN_THREADS];
+
+void main() 
+{
+  int world = int(gl_WorkGroupID.x);
+  int thread = int(gl_LocalInvocationID.x);
+  ivec2 world_origin = ivec2(world % WORLD_COLUMNS, world / WORLD_COLUMNS) * ivec2(WORLD_WIDTH, WORLD_HEIGHT);
+
+  vec3 sum = vec3(0.0);
+  for (int i = thread; i < WORLD_WIDTH * WORLD_HEIGHT; i += SCAN_THREADS)
+  {
+    ivec2 texel = world_origin + ivec2(i % WORLD_WIDTH, i / WORLD_WIDTH);
+    float value = imageLoad(current_image, texel).r;
+    float prev = imageLoad(prev_image, texel).r;
+
+    sum += vec3(value, value * value, abs(value - prev));
+  }
+  sums_[thread] = sum;
+  barrier();
+
+  for (int stride = SCAN_THREADS / 2; stride > 0; stride /= 2)
+  {
+    if (thread < stride)
+      sums_[thread] += sums_[thread + stride];
+    barrier();
+  }
+
+  if (thread == 0)
+  {
+    vec3 mean = sums_[0] / float(WORLD_WIDTH * WORLD_HEIGHT);
+    stats_[world] = vec4(mean.x, max(mean.y - mean.x * mean.x, 0.0), mean.z, 0.0);
+  }
+}
@@ -0,0 +1,58 @@
+layout (local_size_x = FFT_THREADS, local_size_y = 1, local_size_z = 1) in;
+
+layout (binding = FFT_DATA_BIND, std430) buffer FFTDataBlock { vec2 fft_data_[]; };
+
+// One workgroup per line, rows use stride 1 and columns stride C_WIDTH
+// Batches of planes go in the workgroup y, C_WIDTH * C_HEIGHT apart
+// Only the direction and the axis (FFT_AXIS_ROWS or FFT_AXIS_COLUMNS) change between passes
+layout (location = FFT_DIRECTION_LOCATION) uniform float u_direction;
+layout (location = FFT_AXIS_LOCATION) uniform int u_axis;
+
+#define PI 3.14159265358979
+
+shared vec2 line_[FFT_MAX_SIZE];
+
+vec2 ComplexMul(vec2 a, vec2 b)
+{
+  return vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+void main() 
+{
+  bool rows = (u_axis == FFT_AXIS_ROWS);
+  int size = rows ? C_WIDTH : C_HEIGHT;
+  int log2 = findMSB(size);
+  int stride = rows ? 1 : C_WIDTH;
+  int line_stride = rows ? C_WIDTH : 1;
+
+  int base = int(gl_WorkGroupID.x) * line_stride + int(gl_WorkGroupID.y) * C_WIDTH * C_HEIGHT;
+  int thread = int(gl_LocalInvocationID.x);
+
+  // Load in bit reversed order
+  for (int i = thread; i < size; i += FFT_THREADS)
+  {
+    int reversed = int(bitfieldReverse(uint(i)) >> uint(32 - log2));
+    line_[reversed] = fft_data_[base + i * stride];
+  }
+  barrier();
+
+  for (int half_size = 1; half_size < size; half_size <<= 1)
+  {
+    for (int k = thread; k < (size >> 1); k += FFT_THREADS)
+    {
+      int j = k & (half_size - 1);
+      int index = ((k - j) << 1) + j;
+
+      float angle = u_direction * PI * float(j) / float(half_size);
+      vec2 odd = ComplexMul(line_[index + half_size], vec2(cos(angle), sin(angle)));
+      vec2 even = line_[index];
+
+      line_[index] = even + odd;
+      line_[index + half_size] = even - odd;
+    }
+    barrier();
+  }
+
+  for (int i = thread; i < size; i += FFT_THREADS)
+    fft_data_[base + i * stride] = line_[i];
+}
@@ -0,0 +1,24 @@
+layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = 1) in;
+
+layout (binding = CURR_IMG_BIND, CONTINUOUS_STATE) writeonly uniform image2D current_image;
+layout (binding = PREV_IMG_BIND, CONTINUOUS_STATE) readonly uniform image2D prev_image;
+
+layout (binding = FFT_DATA_BIND, std430) readonly buffer FFTDataBlock { vec2 fft_data_[]; };
+
+void main() 
+{
+  ivec2 texelCoord = ivec2(gl_GlobalInvocationID.xy);
+  if (texelCoord.x >= C_WIDTH || texelCoord.y >= C_HEIGHT)
+    return;
+
+  // The kernel spectrum is already normalized, the real part is the weighted average
+  float avg = fft_data_[ARRAY_2D_INDEX(texelCoord.x, texelCoord.y, C_WIDTH)].x;
+
+  float growth = (GaussBell(avg, automata_.mu_, automata_.sigma_) * 2.0) - 1.0;
+
+  float value = imageLoad(prev_image, texelCoord).r;
+
+  float c = clamp(value + (1.0 / automata_.dt_) * growth, 0.0, 1.0);
+
+  imageStore(current_image, texelCoord, vec4(c));
+}
@@ -0,0 +1,16 @@
+layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = 1) in;
+
+layout (binding = PREV_IMG_BIND, CONTINUOUS_STATE) readonly uniform image2D prev_image;
+
+layout (binding = FFT_DATA_BIND, std430) buffer FFTDataBlock { vec2 fft_data_[]; };
+
+void main() 
+{
+  ivec2 texelCoord = ivec2(gl_GlobalInvocationID.xy);
+  if (texelCoord.x >= C_WIDTH || texelCoord.y >= C_HEIGHT)
+    return;
+
+  float alpha = imageLoad(prev_image, texelCoord).r;
+
+  fft_data_[ARRAY_2D_INDEX(texelCoord.x, texelCoord.y, C_WIDTH)] = vec2(alpha, 0.0);
+}
@@ -0,0 +1,17 @@
+layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = 1) in;
+
+layout (binding = FFT_DATA_BIND, std430) buffer FFTDataBlock { vec2 fft_data_[]; };
+layout (binding = FFT_KERNEL_BIND, std430) readonly buffer FFTKernelBlock { vec2 fft_kernel_[]; };
+
+void main() 
+{
+  ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+  if (gid.x >= C_WIDTH || gid.y >= C_HEIGHT)
+    return;
+
+  int index = ARRAY_2D_INDEX(gid.x, gid.y, C_WIDTH);
+  vec2 a = fft_data_[index];
+  vec2 b = fft_kernel_[index];
+
+  fft_data_[index] = vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
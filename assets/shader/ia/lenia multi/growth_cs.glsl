@@ -0,0 +1,39 @@
+layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = 1) in;
+
+layout (binding = CURR_IMG_BIND, MULTI_STATE) writeonly uniform image2D current_image;
+layout (binding = PREV_IMG_BIND, MULTI_STATE) readonly uniform image2D prev_image;
+
+layout (binding = POTENTIAL_BIND, std430) readonly buffer PotentialBlock { vec2 potential_[]; };
+
+void main() 
+{
+  ivec2 texelCoord = ivec2(gl_GlobalInvocationID.xy);
+  if (texelCoord.x >= C_WIDTH || texelCoord.y >= C_HEIGHT)
+    return;
+
+  int plane_size = C_WIDTH * C_HEIGHT;
+  int index = ARRAY_2D_INDEX(texelCoord.x, texelCoord.y, C_WIDTH);
+
+  // Weighted average of the growths that reach each channel
+  vec4 growth = vec4(0.0);
+  vec4 weight = vec4(0.0);
+  for (int kernel = 0; kernel < multi_.kernels_; kernel++)
+  {
+    float avg = potential_[kernel * plane_size + index].x;
+    float kernel_growth = (GaussBell(avg, KERNEL_PARAM(multi_.mu_, kernel), KERNEL_PARAM(multi_.sigma_, kernel)) * 2.0) - 1.0;
+
+    int target = KERNEL_PARAM(multi_.targets_, kernel);
+    float kernel_weight = KERNEL_PARAM(multi_.weights_, kernel);
+    growth[target] += kernel_weight * kernel_growth;
+    weight[target] += kernel_weight;
+  }
+
+  vec4 value = imageLoad(prev_image, texelCoord);
+  for (int channel = 0; channel < LENIA_MAX_CHANNELS; channel++)
+  {
+    if (weight[channel] > 0.0)
+      value[channel] = clamp(value[channel] + (1.0 / multi_.dt_) * (growth[channel] / weight[channel]), 0.0, 1.0);
+  }
+
+  imageStore(current_image, texelCoord, value);
+}
@@ -0,0 +1,17 @@
+layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = 1) in;
+
+layout (binding = PREV_IMG_BIND, MULTI_STATE) readonly uniform image2D prev_image;
+
+layout (binding = FFT_DATA_BIND, std430) buffer FFTDataBlock { vec2 fft_data_[]; };
+
+// One plane per channel, the channel is the workgroup z
+void main() 
+{
+  ivec3 gid = ivec3(gl_GlobalInvocationID.xyz);
+  if (gid.x >= C_WIDTH || gid.y >= C_HEIGHT)
+    return;
+
+  float alpha = imageLoad(prev_image, gid.xy)[gid.z];
+
+  fft_data_[gid.z * C_WIDTH * C_HEIGHT + ARRAY_2D_INDEX(gid.x, gid.y, C_WIDTH)] = vec2(alpha, 0.0);
+}
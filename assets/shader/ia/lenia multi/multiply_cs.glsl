@@ -0,0 +1,21 @@
+layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = 1) in;
+
+layout (binding = FFT_DATA_BIND, std430) readonly buffer FFTDataBlock { vec2 fft_data_[]; };
+layout (binding = FFT_KERNEL_BIND, std430) readonly buffer FFTKernelBlock { vec2 fft_kernel_[]; };
+layout (binding = POTENTIAL_BIND, std430) writeonly buffer PotentialBlock { vec2 potential_[]; };
+
+// The kernel is the workgroup z
+void main() 
+{
+  ivec3 gid = ivec3(gl_GlobalInvocationID.xyz);
+  if (gid.x >= C_WIDTH || gid.y >= C_HEIGHT)
+    return;
+
+  int plane_size = C_WIDTH * C_HEIGHT;
+  int index = ARRAY_2D_INDEX(gid.x, gid.y, C_WIDTH);
+
+  vec2 a = fft_data_[KERNEL_PARAM(multi_.sources_, gid.z) * plane_size + index];
+  vec2 b = fft_kernel_[gid.z * plane_size + index];
+
+  potential_[gid.z * plane_size + index] = vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
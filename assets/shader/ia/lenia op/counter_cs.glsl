@@ -1,49 +1,60 @@
-layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = 1) in;
+layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = COUNTER_LINES) in;
 
-layout (binding = PREV_IMG_BIND, rgba8) readonly uniform image2D prev_image;
-layout (binding = CURR_IMG_BIND, rgba8) writeonly uniform image2D current_image;
+layout (binding = PREV_IMG_BIND, CONTINUOUS_STATE) readonly uniform image2D prev_image;
+layout (binding = CURR_IMG_BIND, CONTINUOUS_STATE) writeonly uniform image2D current_image;
 
 layout (binding = COUNTER_BIND, std430) buffer CounterBlock { Counter data_[]; };
 
-uniform int u_radius;
-uniform float u_dt;
-uniform float u_mu;
-uniform float u_sigma;
-uniform float u_rho;
-uniform float u_omega;
+// Normalized weights, (2 * automata_.extent_ + 1)^2 centered on the cell
+layout (binding = KERNEL_BIND, std430) readonly buffer KernelBlock { float kernel_[]; };
 
-void main() 
-{
-  ivec3 gid = ivec3(gl_GlobalInvocationID.xyz);
-
-  int local_y = (gid.z - u_radius);
-  int neighbour_y = (local_y + gid.y);
-  if (neighbour_y < 0)
-    neighbour_y = (C_HEIGHT + neighbour_y);
-  if (neighbour_y >= C_HEIGHT)
-    neighbour_y -= C_HEIGHT;
+// Row partials of each z thread, reduced before leaving the workgroup
+shared float partial_[COUNTER_LINES][Y_THREADS][X_THREADS];
 
-  int total_columns = TOTAL_COLUMNS(u_radius);
+float RowPartial(ivec2 cell, int local_y)
+{
+  int neighbour_y = WRAP(local_y + cell.y, C_HEIGHT);
+  int kernel_row = ARRAY_2D_INDEX(0, (local_y + automata_.extent_), TOTAL_COLUMNS(automata_.extent_));
 
   float sum = 0.0;
-  float total = 0.0;
-  for (int local_x = -u_radius; local_x <= u_radius; local_x++)
+  for (int local_x = -automata_.extent_; local_x <= automata_.extent_; local_x++)
   {
-    int neighbour_x = (local_x + gid.x);
-    if (neighbour_x < 0)
-      neighbour_x = (C_WIDTH + neighbour_x);
-    if (neighbour_x >= C_WIDTH)
-      neighbour_x -= C_WIDTH;
+    int neighbour_x = WRAP(local_x + cell.x, C_WIDTH);
 
-    float neighbour_alpha = imageLoad(prev_image, ivec2(neighbour_x, neighbour_y)).a;
+    float neighbour_alpha = imageLoad(prev_image, ivec2(neighbour_x, neighbour_y)).r;
 
-    float norm_rad = EuclidianDistance(local_x, local_y) / u_radius;
-    float weight = GaussBell(norm_rad, u_rho, u_omega);
+    float weight = kernel_[kernel_row + local_x + automata_.extent_];
     
     sum += (neighbour_alpha * weight);
-    total += weight;
   }
-  
-  int index = ARRAY_3D_INDEX(gid.x, gid.y, gid.z, C_HEIGHT, MAX_RADIUS);
-  data_[index] = Counter(sum, total);
-}
\ No newline at end of file
+
+  return sum;
+}
+
+void main() 
+{
+  ivec2 cell = ivec2(gl_GlobalInvocationID.xy);
+  uvec3 local = gl_LocalInvocationID;
+
+  // Out of grid threads still reach the barrier
+  bool inside = cell.x < C_WIDTH && cell.y < C_HEIGHT;
+
+  float sum = 0.0;
+  if (inside)
+  {
+    for (int local_y = int(local.z) - automata_.extent_; local_y <= automata_.extent_; local_y += COUNTER_LINES)
+      sum += RowPartial(cell, local_y);
+  }
+
+  partial_[local.z][local.y][local.x] = sum;
+  barrier();
+
+  if (!inside || local.z != 0)
+    return;
+
+  for (int line = 1; line < COUNTER_LINES; line++)
+    sum += partial_[line][local.y][local.x];
+
+  // Weights already add up to one, the count isn't needed
+  data_[ARRAY_2D_INDEX(cell.x, cell.y, C_WIDTH)] = Counter(sum, 0.0);
+}
@@ -0,0 +1,67 @@
+// LENIA_TILE is injected when compiling, the workgroup is a LENIA_TILE^2 tile
+layout (local_size_x = LENIA_TILE, local_size_y = LENIA_TILE, local_size_z = 1) in;
+
+layout (binding = CURR_IMG_BIND, CONTINUOUS_STATE) writeonly uniform image2D current_image;
+layout (binding = PREV_IMG_BIND, CONTINUOUS_STATE) readonly uniform image2D prev_image;
+
+// Normalized weights, (2 * automata_.extent_ + 1)^2 centered on the cell
+layout (binding = KERNEL_BIND, std430) readonly buffer KernelBlock { float kernel_[]; };
+
+#define HALO_SIZE (LENIA_TILE + 2 * LENIA_MAX_RADIUS)
+
+// Tile plus the halo of the kernel, every texel is read once from the image
+shared float tile_[HALO_SIZE * HALO_SIZE];
+
+void LoadTile(ivec2 origin, int side)
+{
+  int thread = int(gl_LocalInvocationIndex);
+  for (int i = thread; i < side * side; i += LENIA_TILE * LENIA_TILE)
+  {
+    ivec2 texel = origin + ivec2(i % side, i / side) - ivec2(automata_.extent_);
+    texel.x = WRAP(texel.x, C_WIDTH);
+    texel.y = WRAP(texel.y, C_HEIGHT);
+
+    tile_[i] = imageLoad(prev_image, texel).r;
+  }
+}
+
+float Convolution(ivec2 local, int side)
+{
+  float sum = 0;
+  int kernel_side = TOTAL_COLUMNS(automata_.extent_);
+  for(int x = -automata_.extent_; x <= automata_.extent_; x++)
+  {
+    for(int y = -automata_.extent_; y <= automata_.extent_; y++)
+    {
+      float alpha = tile_[ARRAY_2D_INDEX((local.x + automata_.extent_ + x), (local.y + automata_.extent_ + y), side)];
+
+      float weight = kernel_[ARRAY_2D_INDEX((x + automata_.extent_), (y + automata_.extent_), kernel_side)];
+
+      sum += (alpha * weight);
+    }
+  }
+  return sum;
+}
+
+void main() 
+{
+  ivec2 texelCoord = ivec2(gl_GlobalInvocationID.xy);
+  ivec2 local = ivec2(gl_LocalInvocationID.xy);
+  int side = LENIA_TILE + 2 * automata_.extent_;
+
+  LoadTile(ivec2(gl_WorkGroupID.xy) * LENIA_TILE, side);
+  barrier();
+
+  if (texelCoord.x >= C_WIDTH || texelCoord.y >= C_HEIGHT)
+    return;
+
+  float avg = Convolution(local, side);
+
+  float growth = (GaussBell(avg, automata_.mu_, automata_.sigma_) * 2.0) - 1.0;
+
+  float value = tile_[ARRAY_2D_INDEX((local.x + automata_.extent_), (local.y + automata_.extent_), side)];
+
+  float c = clamp(value + (1.0 / automata_.dt_) * growth, 0.0, 1.0);
+
+  imageStore(current_image, texelCoord, vec4(c));
+}
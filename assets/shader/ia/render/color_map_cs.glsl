@@ -0,0 +1,23 @@
+layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = 1) in;
+
+layout (binding = DISPLAY_IMG_BIND, rgba8) writeonly uniform image2D display_image;
+
+// Any state format, COLOR_MAP_CHANNELS says how many components are used
+layout (binding = STATE_SAMPLER_BIND) uniform sampler2D u_state;
+
+void main() 
+{
+  ivec2 texelCoord = ivec2(gl_GlobalInvocationID.xy);
+  if (texelCoord.x >= C_WIDTH || texelCoord.y >= C_HEIGHT)
+    return;
+
+#if COLOR_MAP_CHANNELS > 1
+  vec3 channels = texelFetch(u_state, texelCoord, 0).rgb;
+
+  imageStore(display_image, texelCoord, vec4(channels, 1.0));
+#else
+  float value = texelFetch(u_state, texelCoord, 0).r;
+
+  imageStore(display_image, texelCoord, vec4(1.0, 1.0, 1.0, value));
+#endif
+}
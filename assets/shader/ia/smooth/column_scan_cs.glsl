@@ -0,0 +1,21 @@
+layout (local_size_x = SCAN_THREADS, local_size_y = 1, local_size_z = 1) in;
+
+layout (binding = COUNTER_BIND, std430) readonly buffer CounterBlock { Counter data_[]; };
+layout (binding = TABLE_BIND, std430) writeonly buffer TableBlock { uint table_[]; };
+
+// Scans the columns of the row prefix sums into table_, a float table stops being exact past 2^24 cells
+// One invocation per column walks down the rows, the neighbour invocations read the neighbour cells
+void main() 
+{
+  int index_x = int(gl_GlobalInvocationID.x);
+  if (index_x >= C_WIDTH)
+    return;
+
+  uint sum_live = 0u;
+  for (int index_y = 0; index_y < C_HEIGHT; index_y++)
+  {
+    sum_live += uint(data_[index_y * C_WIDTH + index_x].live_);
+
+    table_[index_y * C_WIDTH + index_x] = sum_live;
+  }
+}
@@ -1,27 +1,29 @@
-layout (local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+layout (local_size_x = SCAN_THREADS, local_size_y = 1, local_size_z = 1) in;
 
 layout (binding = COUNTER_BIND, std430) buffer CounterBlock { Counter data_[]; };
-layout (binding = INDICES_BIND, std430) buffer IndicesBlock { vec2 indices_[]; };
 
-layout (binding = CURR_IMG_BIND, rgba8) writeonly uniform image2D current_image;
-layout (binding = PREV_IMG_BIND, rgba8) readonly uniform image2D prev_image;
+layout (binding = PREV_IMG_BIND, BINARY_STATE) readonly uniform image2D prev_image;
 
+#define ROW_CHUNK ((C_WIDTH + SCAN_THREADS - 1) / SCAN_THREADS)
+
+// One workgroup per row, each thread adds a contiguous chunk so the row needs a single workgroup scan
 void main() 
 {
-  int index_y = int(gl_GlobalInvocationID.y);
+  int index_y = int(gl_WorkGroupID.y);
+  int first_x = int(gl_LocalInvocationID.x) * ROW_CHUNK;
+  int last_x = min(first_x + ROW_CHUNK, C_WIDTH);
 
-  float sum_live = 0;
-  uint sum_counter = 0;
+  float chunk_live = 0.0;
+  for (int index_x = first_x; index_x < last_x; index_x++)
+    chunk_live += imageLoad(prev_image, ivec2(index_x, index_y)).r;
 
-  // Acceder a todos los elementos en la dimensión x de cada linea de prev_image y Counter
-  for (int index_x = 0; index_x < C_WIDTH; index_x++)
-  {
-    vec4 pixel_value = imageLoad(prev_image, ivec2(index_x, index_y));
+  float sum_live = WorkgroupInclusiveScan(chunk_live) - chunk_live;
 
-    sum_live += pixel_value.a;
-    sum_counter++;
+  for (int index_x = first_x; index_x < last_x; index_x++)
+  {
+    sum_live += imageLoad(prev_image, ivec2(index_x, index_y)).r;
 
     data_[index_y * C_WIDTH + index_x].live_ = sum_live;
-    data_[index_y * C_WIDTH + index_x].count_ = sum_counter;
+    data_[index_y * C_WIDTH + index_x].count_ = float(index_x + 1);
   }
 }
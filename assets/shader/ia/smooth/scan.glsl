@@ -0,0 +1,64 @@
+// Workgroup scan of the row pass, local_size_x must be SCAN_THREADS
+shared float partial_[SCAN_THREADS];
+
+// Work efficient exclusive scan of the first size (power of two) elements of partial_
+void BlellochScan(uint size)
+{
+  uint thread = gl_LocalInvocationID.x;
+  uint offset = 1;
+
+  for (uint pairs = size >> 1; pairs > 0; pairs >>= 1)
+  {
+    barrier();
+    if (thread < pairs)
+      partial_[offset * (2 * thread + 2) - 1] += partial_[offset * (2 * thread + 1) - 1];
+    offset <<= 1;
+  }
+
+  barrier();
+  if (thread == 0)
+    partial_[size - 1] = 0.0;
+
+  for (uint pairs = 1; pairs < size; pairs <<= 1)
+  {
+    offset >>= 1;
+    barrier();
+    if (thread < pairs)
+    {
+      uint left = offset * (2 * thread + 1) - 1;
+      uint right = offset * (2 * thread + 2) - 1;
+
+      float value = partial_[left];
+      partial_[left] = partial_[right];
+      partial_[right] += value;
+    }
+  }
+
+  barrier();
+}
+
+float WorkgroupInclusiveScan(float value)
+{
+#ifdef GL_KHR_shader_subgroup_arithmetic
+  // Only the subgroup totals go through shared memory
+  float inclusive = subgroupInclusiveAdd(value);
+  uint subgroups = 1;
+  while (subgroups < gl_NumSubgroups)
+    subgroups <<= 1;
+
+  if (gl_SubgroupInvocationID == gl_SubgroupSize - 1)
+    partial_[gl_SubgroupID] = inclusive;
+  if (gl_LocalInvocationID.x >= gl_NumSubgroups && gl_LocalInvocationID.x < subgroups)
+    partial_[gl_LocalInvocationID.x] = 0.0;
+
+  BlellochScan(subgroups);
+
+  return partial_[gl_SubgroupID] + inclusive;
+#else
+  partial_[gl_LocalInvocationID.x] = value;
+
+  BlellochScan(SCAN_THREADS);
+
+  return partial_[gl_LocalInvocationID.x] + value;
+#endif
+}
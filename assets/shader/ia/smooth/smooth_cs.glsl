@@ -1,39 +1,131 @@
 layout (local_size_x = X_THREADS, local_size_y = Y_THREADS, local_size_z = Z_THREADS) in;
 
 layout (binding = COUNTER_BIND, std430) buffer CounterBlock { Counter data_[]; };
-layout (binding = INDICES_BIND, std430) buffer IndicesBlock { vec2 indices_[]; };
 
-layout (binding = CURR_IMG_BIND, rgba8) writeonly uniform image2D current_image;
-layout (binding = PREV_IMG_BIND, rgba8) readonly uniform image2D prev_image;
+layout (binding = CURR_IMG_BIND, BINARY_STATE) writeonly uniform image2D current_image;
+layout (binding = PREV_IMG_BIND, BINARY_STATE) readonly uniform image2D prev_image;
 
-vec2 SumNeighbors(int col, int row, int for_start, int for_end)
+// Whole grid sizes before the coord, negative out of the grid
+int Laps(int value, int size)
 {
-  float sum_life = 0.0;
-  float total_count = 0.0;
+  return (value >= 0) ? (value / size) : -((size - 1 - value) / size);
+}
+
+#ifdef SUMMED_AREA
+// Corners are packed two per ivec4
+ivec2 Level(int level)
+{
+  ivec4 pair = automata_.levels_[level / 2];
+  return ((level % 2) == 0) ? pair.xy : pair.zw;
+}
+
+layout (binding = TABLE_BIND, std430) readonly buffer TableBlock { uint table_[]; };
+
+// Summed area table extended out of the grid, whole rows and columns are added for each lap
+// uint wraps on the negative laps and the overflow, the four prefixes of a rectangle still give its exact count
+uint TablePrefix(int x, int y)
+{
+  int laps_x = Laps(x, C_WIDTH);
+  int laps_y = Laps(y, C_HEIGHT);
+  int local_x = x - laps_x * C_WIDTH;
+  int local_y = y - laps_y * C_HEIGHT;
+
+  uint prefix = table_[ARRAY_2D_INDEX(local_x, local_y, C_WIDTH)];
+
+  if (laps_x != 0)
+    prefix += uint(laps_x) * table_[ARRAY_2D_INDEX((C_WIDTH - 1), local_y, C_WIDTH)];
+  if (laps_y != 0)
+    prefix += uint(laps_y) * table_[ARRAY_2D_INDEX(local_x, (C_HEIGHT - 1), C_WIDTH)];
+  if (laps_x != 0 && laps_y != 0)
+    prefix += uint(laps_x * laps_y) * table_[ARRAY_2D_INDEX((C_WIDTH - 1), (C_HEIGHT - 1), C_WIDTH)];
+
+  return prefix;
+}
+
+// Cells in (start_x, end_x] x (start_y, end_y]
+vec2 RectSum(int start_x, int end_x, int start_y, int end_y)
+{
+  uint live = TablePrefix(end_x, end_y) - TablePrefix(start_x, end_y) - TablePrefix(end_x, start_y) + TablePrefix(start_x, start_y);
+
+  return vec2(float(live), float((end_x - start_x) * (end_y - start_y)));
+}
 
-  for(int z = for_start; z < for_end; z += 2)
+// Disjoint horizontal strips, the middle one then one above and one below for each taller level
+// Every strip corner is a corner of the staircase, no lookup is spent on an overlap
+vec2 SumFar(int col, int row)
+{
+  ivec2 level = Level(0);
+  vec2 sum = RectSum(col - level.x - 1, col + level.x, row - level.y - 1, row + level.y);
+
+  for (int i = 1; i < automata_.level_count_; i++)
   {
-    int index = ARRAY_3D_INDEX(col, row, z, C_HEIGHT, C_DEPTH);
+    int inner_y = level.y;
+    level = Level(i);
 
-    ivec2 start_coord = ivec2(indices_[index]);
-    ivec2 end_coord = ivec2(indices_[index + 1]);
+    sum += RectSum(col - level.x - 1, col + level.x, row + inner_y, row + level.y);
+    sum += RectSum(col - level.x - 1, col + level.x, row - level.y - 1, row - inner_y - 1);
+  }
 
-    Counter start_counter = data_[start_coord.x + start_coord.y * C_WIDTH];
-    Counter end_counter = data_[end_coord.x + end_coord.y * C_WIDTH];
+  return sum;
+}
 
-    Counter counter = Counter(end_counter.live_ - start_counter.live_, end_counter.count_ - start_counter.count_);
-    
-    sum_life += counter.live_;
-    total_count += counter.count_;
+vec2 SumNear(int col, int row)
+{
+  return RectSum(col - 1, col + 1, row - 2, row + 1);
+}
+#else
+// Prefix sum of the row extended out of the grid, whole rows are added for each lap
+Counter RowPrefix(int x, int row)
+{
+  int laps = Laps(x, C_WIDTH);
+  int local_x = x - laps * C_WIDTH;
+  int wrapped_row = WRAP(row, C_HEIGHT);
+
+  Counter lap = data_[ARRAY_2D_INDEX((C_WIDTH - 1), wrapped_row, C_WIDTH)];
+  Counter prefix = data_[ARRAY_2D_INDEX(local_x, wrapped_row, C_WIDTH)];
+
+  return Counter(float(laps) * lap.live_ + prefix.live_, float(laps) * lap.count_ + prefix.count_);
+}
+
+// Cells in (start_x, end_x] of the row
+vec2 RowSpan(int start_x, int end_x, int row)
+{
+  Counter start_counter = RowPrefix(start_x, row);
+  Counter end_counter = RowPrefix(end_x, row);
+
+  return vec2(end_counter.live_ - start_counter.live_, end_counter.count_ - start_counter.count_);
+}
+
+vec2 SumNear(int col, int row)
+{
+  vec2 sum = vec2(0.0);
+
+  for (int y = -1; y <= 1; y++)
+    sum += RowSpan(col - 1, col + 1, row + y);
+
+  return sum;
+}
+
+// Disk of rows, the span of each row only depends on its offset
+vec2 SumFar(int col, int row)
+{
+  vec2 sum = vec2(0.0);
+  int radius = int(automata_.radius_);
+
+  for (int y = -radius; y <= radius; y++)
+  {
+    int x_offset = int(floor(sqrt(automata_.radius_ * automata_.radius_ - float(y * y))));
+    sum += RowSpan(col - x_offset - 1, col + x_offset, row + y);
   }
 
-  return vec2(sum_life, total_count);
+  return sum;
 }
+#endif
 
 float getAlpha(int col, int row)
 {
-  vec2 far = SumNeighbors(col, row, NEAR_NEIGHBORS, C_DEPTH);
-  vec2 near = SumNeighbors(col, row, 0, NEAR_NEIGHBORS);
+  vec2 far = SumFar(col, row);
+  vec2 near = SumNear(col, row);
 
   far -= near;
 
@@ -54,9 +146,8 @@ float getAlpha(int col, int row)
 void main() 
 {
   ivec2 texelCoord = ivec2(gl_GlobalInvocationID.xy);
-  vec4 currentColor = imageLoad(prev_image, texelCoord);
-
-  vec4 updatedColor = vec4(currentColor.rgb, getAlpha(texelCoord.x, texelCoord.y));
+  if (texelCoord.x >= C_WIDTH || texelCoord.y >= C_HEIGHT)
+    return;
 
-  imageStore(current_image, texelCoord, updatedColor);
+  imageStore(current_image, texelCoord, vec4(getAlpha(texelCoord.x, texelCoord.y)));
 }
\ No newline at end of file
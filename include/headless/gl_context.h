@@ -0,0 +1,10 @@
+#include "engine/engine.h"
+
+#ifndef __GL_CONTEXT_H__
+#define __GL_CONTEXT_H__ 1
+
+// GL context without window, EGL surfaceless on Linux and a hidden GLFW window on Windows
+boolean CreateContext();
+void DestroyContext();
+
+#endif /* __GL_CONTEXT_H__ */
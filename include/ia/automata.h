@@ -0,0 +1,38 @@
+#include "engine/engine.h"
+#include "seed.h"
+
+#ifndef __AUTOMATA_H__
+#define __AUTOMATA_H__ 1
+
+// Surface shared by every engine, the window and the headless runner only step them through it
+class Automata
+{
+public:
+  virtual ~Automata() {}
+
+  virtual void init(Math::Vec2 win) = 0;
+
+  virtual void update() = 0;
+  virtual void imgui() = 0;
+
+  virtual void reset() = 0;
+  virtual void clean() = 0;
+
+  virtual u32 currentTexture() = 0;
+
+  // Bytes held by its textures, buffers and CPU copies
+  virtual u64 memoryUsage() const = 0;
+
+  // Builds every program again, the ones that fail keep the old version
+  // CPU engines have nothing to build
+  virtual boolean compileShaders() { return true; }
+
+  // False while a program it steps with has never built, update() does nothing until one
+  // compileShaders() builds them
+  virtual boolean ready() const { return true; }
+
+  // Initial state of reset()
+  SeedConfig seed_;
+};
+
+#endif /* __AUTOMATA_H__ */
@@ -0,0 +1,78 @@
+#include "engine/engine.h"
+#include "automata.h"
+
+#ifndef __BACKENDS_H__
+#define __BACKENDS_H__ 1
+
+#define BACKEND_CACHE_FILE "backend_cache.txt"
+
+// Each backend is stepped up to CALIBRATION_STEPS generations or CALIBRATION_MCS microseconds,
+// the first update builds programs and kernels and isn't measured
+#define CALIBRATION_STEPS 16
+#define CALIBRATION_MCS 250000
+
+enum class Rule
+{
+  Conway,
+  SmoothLife,
+  Lenia
+};
+
+// Read by every backend of a rule, negative values keep the engine defaults
+struct RuleParams
+{
+  f32 radius_ = -1.0f;
+  f32 dt_ = -1.0f;
+  f32 mu_ = -1.0f;
+  f32 sigma_ = -1.0f;
+  f32 rho_ = -1.0f;
+  f32 omega_ = -1.0f;
+};
+
+// One interchangeable implementation of a rule. The binary rules give the same generations on every backend,
+// Lenia ones agree within the conformance tolerance (1/64 per cell by default): the GPU backends keep R16F
+// cells and fft_cpu f32, so long runs of different backends drift apart
+struct BackendInfo
+{
+  const byte *name_;
+  Rule rule_;
+
+  // Needs a GL context to step
+  boolean gpu_;
+
+  // Can step the grid and radius with the results above
+  boolean (*available_)(u32 width, u32 height, f32 radius);
+  std::unique_ptr<Automata> (*create_)(Math::Vec2 size, const RuleParams &params);
+};
+
+// Backends of every rule, the fastest one for a grid and radius is measured once and kept
+// per machine (renderer and CPU threads) in BACKEND_CACHE_FILE
+class Backends
+{
+public:
+  // The ones that can run the grid, GPU backends only when there's a context
+  static std::vector<const BackendInfo *> List(Rule rule, u32 width, u32 height, f32 radius, boolean gpu);
+  static const BackendInfo *Find(Rule rule, const byte *name);
+
+  // Cached choice, calibrated the first time
+  static const BackendInfo *Select(Rule rule, u32 width, u32 height, const RuleParams &params, boolean gpu);
+
+  // Steps every available backend and stores the fastest, available_ only lists the ones that are exact
+  // (binary rules) or within the tolerance (Lenia) for the grid and radius
+  static const BackendInfo *Calibrate(Rule rule, u32 width, u32 height, const RuleParams &params, boolean gpu);
+
+  // Initialized engine with the params applied
+  static std::unique_ptr<Automata> Create(const BackendInfo &backend, u32 width, u32 height, const RuleParams &params);
+
+  // The params radius or the default of the rule
+  static f32 Radius(Rule rule, const RuleParams &params);
+
+  static const byte *RuleName(Rule rule);
+  static boolean ParseRule(const byte *name, Rule &rule);
+
+private:
+  Backends();
+  ~Backends();
+};
+
+#endif /* __BACKENDS_H__ */
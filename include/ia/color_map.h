@@ -0,0 +1,27 @@
+#include "engine/engine.h"
+
+#ifndef __COLOR_MAP_H__
+#define __COLOR_MAP_H__ 1
+
+// Turns a state texture into the RGBA8 texture used to render
+// One channel is drawn as white alpha, more channels as their colors
+class ColorMap
+{
+public:
+  ColorMap();
+  void init(u32 width, u32 height, u32 channels = 1);
+  ~ColorMap();
+
+  // Only needed to display, the simulation never reads the result
+  u32 apply(u32 state_texture);
+
+  u64 memoryUsage() const;
+
+private:
+  u32 width_, height_;
+
+  u32 program_;
+  u32 display_id_;
+};
+
+#endif /* __COLOR_MAP_H__ */
@@ -1,35 +1,51 @@
 #include "engine/engine.h"
+#include "color_map.h"
+#include "gpu_profiler.h"
+#include "automata.h"
+#include "staging_buffer.h"
 
 #ifndef __CONWAY_H__
 #define __CONWAY_H__ 1
 
-class Conway
+class Conway : public Automata
 {
 public:
   Conway();
-  void init(Math::Vec2 win);
+  void init(Math::Vec2 win) override;
   ~Conway();
 
-  void update();
-  void imgui();
+  void update() override;
+  void imgui() override;
 
-  void reset();
-  void clean();
+  void reset() override;
+  void clean() override;
 
-  u32 currentTexture();
+  u32 currentTexture() override;
+  u64 memoryUsage() const override;
+  boolean compileShaders() override;
+  boolean ready() const override;
+
+  // One value per cell, row major like CPUReference, to compare both
+  void setCells(const f32 *cells);
+  void getCells(f32 *cells);
 
 private:
-  void compileShaders();
   void swap();
 
   TimeCont update_timer_;
   u32 loops_;
 
+  GPUProfiler profiler_;
+  u32 automata_section_;
+
   u32 compute_program_;
 
   u32 width_, height_;
 
   u32 prev_data_id_, current_data_id_;
+  StagingBuffer staging_;
+
+  ColorMap color_map_;
 };
 
 #endif /* __CONWAY_H__ */
@@ -0,0 +1,50 @@
+#include "engine/engine.h"
+#include "automata.h"
+
+#ifndef __CONWAY_CPU_H__
+#define __CONWAY_CPU_H__ 1
+
+// Conway on the CPU with 64 cells packed per word, no GPU needed
+class ConwayCPU : public Automata
+{
+public:
+  ConwayCPU();
+  void init(Math::Vec2 win) override;
+  ~ConwayCPU();
+
+  void update() override;
+  void imgui() override;
+
+  void reset() override;
+  void clean() override;
+
+  u32 currentTexture() override;
+  u64 memoryUsage() const override;
+
+  // RGBA8 import/export (Alpha is the cell) to compare with the GPU version
+  void setCells(const u_byte *rgba);
+  void getCells(u_byte *rgba) const;
+  boolean cell(u32 x, u32 y) const;
+
+private:
+  void stepRows(u32 first_row, u32 last_row);
+  void swap();
+
+  TimeCont update_timer_;
+  u32 loops_;
+
+  u32 width_, height_;
+  u32 words_per_row_;
+  u64 last_word_mask_;
+
+  u32 bands_;
+  boolean avx2_;
+
+  std::vector<u64> prev_cells_, current_cells_;
+
+  std::vector<u_byte> staging_;
+  boolean texture_dirty_;
+  u32 texture_id_;
+};
+
+#endif /* __CONWAY_CPU_H__ */
@@ -0,0 +1,61 @@
+#include "engine/engine.h"
+#include "color_map.h"
+#include "gpu_profiler.h"
+#include "automata.h"
+#include "staging_buffer.h"
+
+#ifndef __CONWAY_PACKED_H__
+#define __CONWAY_PACKED_H__ 1
+
+// Conway with 32 cells per uint in storage buffers, one invocation adds the neighbours of a whole word
+// with bitwise adders. The state takes one bit per cell so grids of 16384^2 and more fit
+class ConwayPacked : public Automata
+{
+public:
+  ConwayPacked();
+  void init(Math::Vec2 win) override;
+  ~ConwayPacked();
+
+  void update() override;
+  void imgui() override;
+
+  void reset() override;
+  void clean() override;
+
+  // Unpacked on demand, grids past PACKED_DISPLAY_SIZE are shown downscaled
+  u32 currentTexture() override;
+  u64 memoryUsage() const override;
+  boolean compileShaders() override;
+  boolean ready() const override;
+
+  // One value per cell, row major like CPUReference, to compare both
+  void setCells(const f32 *cells);
+  void getCells(f32 *cells);
+
+private:
+  void swap();
+
+  TimeCont update_timer_;
+  u32 loops_;
+
+  GPUProfiler profiler_;
+  u32 automata_section_, unpack_section_;
+
+  u32 compute_program_, unpack_program_;
+
+  u32 width_, height_;
+  u32 row_words_;
+
+  u32 display_scale_;
+  u32 display_width_, display_height_;
+  boolean display_dirty_;
+
+  u32 prev_cells_ssbo_, current_cells_ssbo_;
+  u32 display_data_id_;
+  StagingBuffer staging_;
+  std::vector<u32> words_;
+
+  ColorMap color_map_;
+};
+
+#endif /* __CONWAY_PACKED_H__ */
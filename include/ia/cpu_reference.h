@@ -0,0 +1,91 @@
+#include "engine/engine.h"
+#include "kernel_table.h"
+#include "automata.h"
+
+#ifndef __CPU_REFERENCE_H__
+#define __CPU_REFERENCE_H__ 1
+
+// Automatas that CPUReference can run
+enum class ReferenceType
+{
+  Conway,
+  SmoothLife,
+  Lenia,
+  LeniaOp
+};
+
+// How continuous cells are stored after every write, GL leaves the half float rounding to the driver
+enum class ReferencePrecision
+{
+  Float,
+  HalfNearest,
+  HalfTowardZero
+};
+
+// CPU versions of the GPU automatas with the same rules, wrapping and parameters as the shaders
+// Rows are split over the TaskManager, used without GPU and as the golden reference of the shaders
+class CPUReference : public Automata
+{
+public:
+  CPUReference(ReferenceType type);
+  void init(Math::Vec2 win) override;
+  ~CPUReference();
+
+  void update() override;
+  void imgui() override;
+
+  void reset() override;
+  void clean() override;
+
+  u32 currentTexture() override;
+  u64 memoryUsage() const override;
+
+  // One value per cell, row major
+  void setCells(const f32 *cells);
+  const std::vector<f32> &cells() const;
+
+  ReferenceType type() const;
+  u32 generation() const;
+
+  // SmoothLife outer radius, LeniaOp truncates it like its s32 radius
+  f32 radius_;
+  f32 dt_;
+  f32 mu_;
+  f32 sigma_;
+  f32 rho_;
+  f32 omega_;
+
+  // Continuous cells are rounded like the R16F state textures, HalfNearest by default
+  ReferencePrecision precision_;
+
+private:
+  void stepConway(u32 first_row, u32 last_row);
+  void stepSmoothLife(u32 first_row, u32 last_row);
+  void stepLenia(u32 first_row, u32 last_row);
+  void stepLeniaOp(u32 first_row, u32 last_row);
+
+  f32 rowSpan(s32 start_x, s32 end_x, s32 row) const;
+  f32 growth(f32 value, f32 avg) const;
+  f32 store(f32 value) const;
+  void swap();
+
+  ReferenceType type_;
+
+  TimeCont update_timer_;
+  u32 loops_;
+
+  u32 width_, height_;
+
+  KernelTable kernel_;
+
+  std::vector<f32> prev_cells_, current_cells_;
+
+  // SmoothLife inclusive prefix sum of every row
+  std::vector<f32> row_prefix_;
+
+  std::vector<u_byte> staging_;
+  boolean texture_dirty_;
+  u32 texture_id_;
+};
+
+#endif /* __CPU_REFERENCE_H__ */
@@ -6,19 +6,62 @@
 #define PREV_IMG_BIND 0
 #define CURR_IMG_BIND 1
 #define COUNTER_BIND 2
-#define INDICES_BIND 3
-
-#define SECTORS 4
+#define FFT_DATA_BIND 4
+#define FFT_KERNEL_BIND 5
+#define KERNEL_BIND 6
+#define DISPLAY_IMG_BIND 7
+// Texture unit of the color map input, units don't share numbers with images or buffers
+#define STATE_SAMPLER_BIND 0
+#define POTENTIAL_BIND 8
+#define ENSEMBLE_PARAMS_BIND 9
+#define ENSEMBLE_STATS_BIND 10
+#define PARAMS_BIND 11
+#define PACKED_PREV_BIND 12
+#define PACKED_CURR_BIND 13
+#define TABLE_BIND 14
+#define MULTI_PARAMS_BIND 15
+
+#define FFT_THREADS 256
+#define FFT_MAX_SIZE 2048
+
+// Uniforms of fft_cs.glsl, the sizes and strides are compiled in
+#define FFT_DIRECTION_LOCATION 0
+#define FFT_AXIS_LOCATION 1
+#define FFT_AXIS_ROWS 0
+#define FFT_AXIS_COLUMNS 1
+
+#define SCAN_THREADS 256
+// Corners of the disk staircase, radius 32 (The top of the slider) needs 20, even for the ivec4 packing
+#define SUMMED_AREA_LEVELS 20
+
+// State is a single channel, binary automatas don't need more than 8 bits
+#define BINARY_STATE_FORMAT GL_R8
+#define CONTINUOUS_STATE_FORMAT GL_R16F
+
+// Multi channel Lenia keeps each channel in one component
+#define MULTI_STATE_FORMAT GL_RGBA16F
+
+// Largest side of the ConwayPacked display texture, bigger grids show the alive fraction of square blocks
+#define PACKED_DISPLAY_SIZE 4096
 
 #define MAX_RADIUS 20
+#define LENIA_MAX_RADIUS 25
+#define LENIA_MAX_CHANNELS 3
+#define LENIA_MAX_KERNELS 16
+#define LENIA_MAX_PEAKS 3
+
+// Ensemble worlds are stepped in LENIA_TILE^2 tiles that never cross two worlds
+#define ENSEMBLE_TILE 16
+#define ENSEMBLE_MAX_WORLDS 4096
+
+// Kernel rows split between the z threads of a LeniaOp counter workgroup
+#define COUNTER_LINES 4
 #define O_RADIUS 12.0f
 #define I_RADIUS 1.44f
 
-#define NEAR_NEIGHBORS 6
-
+// Default grid, the engines get their size in init and the shaders per instance
 #define C_WIDTH 1024
 #define C_HEIGHT 1024
-#define C_DEPTH (static_cast<s32>(NEAR_NEIGHBORS + (O_RADIUS * SECTORS)))
 #define TOTAL_LINES(rad) (static_cast<u32>((rad * 2) + 1))
 #define TOTAL_COLUMNS(rad) (static_cast<u32>((rad * 2) + 1))
 
@@ -37,6 +80,33 @@ struct Counter
   f32 count_;
 };
 
+// std140 mirror of AutomataBlock, each engine fills the members its shaders read
+struct AutomataParams
+{
+  s32 extent_;
+  f32 radius_;
+  f32 dt_;
+  f32 mu_;
+  f32 sigma_;
+  s32 level_count_;
+  s32 padding_[2];
+  // SmoothLife summed area corners, two per ivec4
+  s32 levels_[SUMMED_AREA_LEVELS * 2];
+};
+
+// std140 mirror of MultiBlock, the per kernel arrays are packed four per ivec4 / vec4
+struct MultiParams
+{
+  s32 kernels_;
+  f32 dt_;
+  s32 padding_[2];
+  s32 sources_[LENIA_MAX_KERNELS];
+  s32 targets_[LENIA_MAX_KERNELS];
+  f32 mu_[LENIA_MAX_KERNELS];
+  f32 sigma_[LENIA_MAX_KERNELS];
+  f32 weights_[LENIA_MAX_KERNELS];
+};
+
 #define GaussBell(x, m, s) (expf(-(x - m) * (x - m) / s / s / 2.0f))
 #define EuclidianDistance(x, y) (sqrtf(x * x + y * y))
 
@@ -44,9 +114,18 @@ struct Counter
 #define Y_THREADS 8 // May need to be 4
 #define Z_THREADS 1
 
+// Between generations the next dispatch only reads images and buffers, ColorMap and the readbacks add their own bits
+#define STEP_BARRIER_BITS (GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT)
+
+// Workgroups to cover every cell, the shaders skip the ones out of the grid
+#define DISPATCH_GROUPS(size, threads) ((static_cast<u32>(size) + (threads) - 1) / (threads))
+
 const char defines[] = R"(
 #version 460
 
+// Optional, the shaders check GL_KHR_shader_subgroup_arithmetic before using it
+#extension GL_KHR_shader_subgroup_arithmetic : enable
+
 #define X_THREADS 8
 #define Y_THREADS 8 // May need to be 4
 #define Z_THREADS 1
@@ -54,24 +133,60 @@ const char defines[] = R"(
 #define PREV_IMG_BIND 0
 #define CURR_IMG_BIND 1
 #define COUNTER_BIND 2
-#define INDICES_BIND 3
-
-#define SECTORS 4
+#define FFT_DATA_BIND 4
+#define FFT_KERNEL_BIND 5
+#define KERNEL_BIND 6
+#define DISPLAY_IMG_BIND 7
+// Texture unit of the color map input, units don't share numbers with images or buffers
+#define STATE_SAMPLER_BIND 0
+#define POTENTIAL_BIND 8
+#define ENSEMBLE_PARAMS_BIND 9
+#define ENSEMBLE_STATS_BIND 10
+#define PARAMS_BIND 11
+#define PACKED_PREV_BIND 12
+#define PACKED_CURR_BIND 13
+#define TABLE_BIND 14
+#define MULTI_PARAMS_BIND 15
+
+#define FFT_THREADS 256
+#define FFT_MAX_SIZE 2048
+
+// Uniforms of fft_cs.glsl, the sizes and strides are compiled in
+#define FFT_DIRECTION_LOCATION 0
+#define FFT_AXIS_LOCATION 1
+#define FFT_AXIS_ROWS 0
+#define FFT_AXIS_COLUMNS 1
+
+#define SCAN_THREADS 256
+// Corners of the disk staircase, radius 32 (The top of the slider) needs 20, even for the ivec4 packing
+#define SUMMED_AREA_LEVELS 20
+
+#define BINARY_STATE r8
+#define CONTINUOUS_STATE r16f
+#define MULTI_STATE rgba16f
 
 #define MAX_RADIUS 20
+#define LENIA_MAX_RADIUS 25
+#define LENIA_MAX_CHANNELS 3
+#define LENIA_MAX_KERNELS 16
+#define LENIA_MAX_PEAKS 3
+
+// Ensemble worlds are stepped in LENIA_TILE^2 tiles that never cross two worlds
+#define ENSEMBLE_TILE 16
+#define ENSEMBLE_MAX_WORLDS 4096
+
+// Kernel rows split between the z threads of a LeniaOp counter workgroup
+#define COUNTER_LINES 4
 #define O_RADIUS 12.0
 #define I_RADIUS 1.44
 
-#define NEAR_NEIGHBORS 6
-
-#define C_WIDTH 1024
-#define C_HEIGHT 1024
-#define C_DEPTH int(NEAR_NEIGHBORS + (O_RADIUS * SECTORS))
 #define TOTAL_LINES(rad) ((rad * 2) + 1)
 #define TOTAL_COLUMNS(rad) ((rad * 2) + 1)
 
 #define ARRAY_3D_INDEX(x, y, z, max_y, max_z) int((x *  max_y * max_z) + (y * max_z) + (z))
 #define ARRAY_2D_INDEX(x, y, max_x) int((y * max_x) + (x))
+// GLSL % is undefined with negative operands
+#define WRAP(value, size) (((value) >= 0) ? ((value) % (size)) : ((size) - 1 - ((-(value) - 1) % (size))))
 
 struct Counter
 {
@@ -79,8 +194,36 @@ struct Counter
   float count_;
 };
 
+// Shared by every program of an engine, only uploaded when a value changes
+layout (binding = PARAMS_BIND, std140) uniform AutomataBlock
+{
+  int extent_;
+  float radius_;
+  float dt_;
+  float mu_;
+  float sigma_;
+  int level_count_;
+  ivec4 levels_[SUMMED_AREA_LEVELS / 2];
+} automata_;
+
 #define GaussBell(x, m, s) (exp(-(x - m) * (x - m) / s / s / 2.0f))
 #define EuclidianDistance(x, y) (sqrt(x * x + y * y))
 )";
 
+// Multi channel Lenia kernels, only the lenia multi sources that read them get it after defines
+const char multi_block[] = R"(
+// KERNEL_PARAM(multi_.mu_, k) reads the value of kernel k
+layout (binding = MULTI_PARAMS_BIND, std140) uniform MultiBlock
+{
+  int kernels_;
+  float dt_;
+  ivec4 sources_[LENIA_MAX_KERNELS / 4];
+  ivec4 targets_[LENIA_MAX_KERNELS / 4];
+  vec4 mu_[LENIA_MAX_KERNELS / 4];
+  vec4 sigma_[LENIA_MAX_KERNELS / 4];
+  vec4 weights_[LENIA_MAX_KERNELS / 4];
+} multi_;
+#define KERNEL_PARAM(array, k) array[(k) / 4][(k) % 4]
+)";
+
 #endif /* __IA_DEFINES_H__ */
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "engine/engine.h"
+#include <complex>
+
+#ifndef __FFT_H__
+#define __FFT_H__ 1
+
+typedef std::complex<f32> Complex;
+
+// 1D complex FFT of any size (radix 2, Bluestein when the size isn't a power of two)
+class FFT
+{
+public:
+  FFT();
+  void init(u32 size);
+  ~FFT();
+
+  // In place and unnormalized, scratch needs scratchSize() elements
+  void forward(Complex *data, Complex *scratch) const;
+  void inverse(Complex *data, Complex *scratch) const;
+
+  u32 size() const;
+  u32 scratchSize() const;
+
+  static boolean IsPowerOfTwo(u32 value);
+
+private:
+  void radix2(Complex *data, boolean inverse) const;
+  void bluestein(Complex *data, Complex *scratch) const;
+
+  u32 size_;
+  u32 padded_size_;
+  u32 log2_;
+
+  std::vector<u32> reversed_;
+  std::vector<Complex> twiddles_;
+
+  // Bluestein
+  std::vector<Complex> chirp_;
+  std::vector<Complex> chirp_spectrum_;
+};
+
+// 2D complex FFT, rows and columns are split over the TaskManager
+class FFT2D
+{
+public:
+  FFT2D();
+  void init(u32 width, u32 height);
+  ~FFT2D();
+
+  void forward(Complex *data) const;
+  void inverse(Complex *data) const;
+
+  u32 width() const;
+  u32 height() const;
+
+private:
+  void transform(Complex *data, boolean inverse) const;
+  void rows(Complex *data, boolean inverse, u32 first_row, u32 last_row) const;
+  void columns(Complex *data, boolean inverse, u32 first_column, u32 last_column) const;
+
+  u32 width_, height_;
+
+  FFT row_fft_, column_fft_;
+};
+
+#endif /* __FFT_H__ */
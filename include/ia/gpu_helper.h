@@ -7,8 +7,18 @@ class GPUHelper
 {
 public:
   static u32 CreateTexture(u32 width, u32 height, u_byte *data);
-  static u32 CompileShader(u32 shader_type, const byte *source, const char *name);
-  static u32 CreateProgram(u32 compute_shader, const char *name);
+
+  // Single channel simulation state, data is one value per cell (u_byte or f32 given by type)
+  static u32 CreateStateTexture(u32 width, u32 height, u32 internal_format);
+  static void UploadState(u32 texture, u32 width, u32 height, u32 type, const void *data);
+  static void DownloadState(u32 texture, u32 type, void *data);
+
+  // GPU side, no CPU buffer needed
+  static void ClearState(u32 texture);
+  static void CopyState(u32 source, u32 destination, u32 width, u32 height);
+
+  // C_WIDTH & C_HEIGHT of one engine, goes after the defines string
+  static std::string GridDefines(u32 width, u32 height);
 
 private:
   GPUHelper();
@@ -0,0 +1,52 @@
+#include "engine/engine.h"
+
+#ifndef __GPU_PROFILER_H__
+#define __GPU_PROFILER_H__ 1
+
+#define GPU_PROFILER_LATENCY 4
+#define GPU_PROFILER_SAMPLES 128
+
+// GL_TIME_ELAPSED queries per dispatch, results are read GPU_PROFILER_LATENCY frames later without stalling
+class GPUProfiler
+{
+public:
+  GPUProfiler();
+  ~GPUProfiler();
+
+  // Returns the id used by begin
+  u32 addSection(const char *name);
+
+  void begin(u32 section);
+  void end();
+
+  // Collects the finished queries, call once per update
+  void frame();
+
+  // Rolling stats in microseconds
+  f64 min(u32 section) const;
+  f64 average(u32 section) const;
+  f64 percentile(u32 section, f64 percent) const;
+
+  void imgui() const;
+
+private:
+  struct Section
+  {
+    const char *name_;
+
+    u32 queries_[GPU_PROFILER_LATENCY];
+    boolean pending_[GPU_PROFILER_LATENCY];
+
+    f64 samples_[GPU_PROFILER_SAMPLES];
+    u32 next_sample_;
+    u32 total_samples_;
+  };
+
+  void collect(Section &section, u32 slot);
+
+  std::vector<Section> sections_;
+  u32 slot_;
+  s32 active_;
+};
+
+#endif /* __GPU_PROFILER_H__ */
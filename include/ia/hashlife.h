@@ -0,0 +1,91 @@
+#include "engine/engine.h"
+#include "automata.h"
+
+#ifndef __HASHLIFE_H__
+#define __HASHLIFE_H__ 1
+
+// Largest step_, 2^48 generations per update
+#define HASHLIFE_MAX_STEP 48
+
+// Conway on an infinite plane with a memoized quadtree, each update jumps 2^step_ generations
+class Hashlife : public Automata
+{
+public:
+  Hashlife();
+  void init(Math::Vec2 win) override;
+  ~Hashlife();
+
+  void update() override;
+  void imgui() override;
+
+  void reset() override;
+  void clean() override;
+
+  u32 currentTexture() override;
+  u64 memoryUsage() const override;
+
+  // The window [-width / 2, width / 2) x [-height / 2, height / 2) as a Conway RGBA8 grid
+  void setCells(const u_byte *rgba);
+  void getCells(u_byte *rgba);
+  void loadTexture(u32 texture_id);
+  void storeTexture(u32 texture_id);
+
+  u64 generation() const;
+  u64 population() const;
+
+  s32 step_;
+  s32 max_nodes_;
+
+private:
+  struct Node
+  {
+    u32 nw_, ne_, sw_, se_;
+    u32 result_;
+    u32 level_;
+    u64 population_;
+  };
+
+  struct NodeKey
+  {
+    u32 nw_, ne_, sw_, se_;
+    bool operator==(const NodeKey &other) const;
+  };
+
+  struct NodeKeyHash
+  {
+    size_t operator()(const NodeKey &key) const;
+  };
+
+  u32 join(u32 nw, u32 ne, u32 sw, u32 se);
+  u32 emptyNode(u32 level);
+  u32 centre(u32 node);
+  u32 expand(u32 node);
+  boolean centred(u32 node);
+  u32 baseSuccessor(u32 node);
+  u32 successor(u32 node);
+  u32 build(const u_byte *rgba, u32 level, s64 x, s64 y);
+  void draw(u32 node, s64 x, s64 y, u_byte *rgba);
+  u32 intern(const std::vector<Node> &old_nodes, u32 node, std::vector<u32> &remap);
+  void collect();
+  void clearResults();
+  void clearNodes();
+
+  TimeCont update_timer_;
+  u32 loops_;
+
+  u32 width_, height_;
+
+  std::vector<Node> nodes_;
+  std::unordered_map<NodeKey, u32, NodeKeyHash> table_;
+  std::vector<u32> empty_;
+  u32 root_;
+
+  s32 results_step_;
+  u64 generation_;
+
+  std::vector<u_byte> staging_;
+  boolean texture_dirty_;
+  u32 texture_id_;
+};
+
+#endif /* __HASHLIFE_H__ */
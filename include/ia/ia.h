@@ -3,8 +3,15 @@
 
 #include "defines.h"
 #include "conway.h"
+#include "conway_cpu.h"
+#include "conway_packed.h"
+#include "cpu_reference.h"
+#include "hashlife.h"
 #include "smooth_life.h"
 #include "lenia.h"
 #include "lenia_op.h"
+#include "lenia_fft.h"
+#include "lenia_multi.h"
+#include "lenia_ensemble.h"
 
 #endif /* __IA_H__ */
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "engine/engine.h"
+
+#ifndef __KERNEL_TABLE_H__
+#define __KERNEL_TABLE_H__ 1
+
+// Normalized Lenia kernel weights, only rebuilt when radius, rho, omega or the ring peaks change
+class KernelTable
+{
+public:
+  KernelTable();
+  ~KernelTable();
+
+  // Returns true when the weights had to be built again
+  boolean update(f32 radius, f32 rho, f32 omega);
+
+  // Concentric rings of the given peak heights, the last ring goes on past the radius
+  boolean update(f32 radius, f32 rho, f32 omega, const std::vector<f32> &peaks);
+
+  // Uploads the weights when needed and binds them as a SSBO
+  void bind(u32 binding);
+
+  // Weights are stored row major in a (2 * extent + 1)^2 square centered on the cell
+  s32 extent() const;
+  const std::vector<f32> &weights() const;
+
+private:
+  f32 radius_, rho_, omega_;
+  std::vector<f32> peaks_;
+  s32 extent_;
+
+  std::vector<f32> weights_;
+
+  boolean uploaded_;
+  u32 ssbo_;
+  size_t ssbo_size_;
+};
+
+#endif /* __KERNEL_TABLE_H__ */
@@ -1,22 +1,35 @@
 #include "engine/engine.h"
+#include "kernel_table.h"
+#include "color_map.h"
+#include "gpu_profiler.h"
+#include "automata.h"
+#include "staging_buffer.h"
+#include "param_block.h"
 
 #ifndef __LENIA_H__
 #define __LENIA_H__ 1
 
-class Lenia
+class Lenia : public Automata
 {
 public:
   Lenia();
-  void init(Math::Vec2 win);
+  void init(Math::Vec2 win) override;
   ~Lenia();
 
-  void update();
-  void imgui();
+  void update() override;
+  void imgui() override;
 
-  void reset();
-  void clean();
+  void reset() override;
+  void clean() override;
 
-  u32 currentTexture();
+  u32 currentTexture() override;
+  u64 memoryUsage() const override;
+  boolean compileShaders() override;
+  boolean ready() const override;
+
+  // One value per cell, row major like CPUReference, to compare both
+  void setCells(const f32 *cells);
+  void getCells(f32 *cells);
 
   float radius_;
   float dt_;
@@ -24,19 +37,35 @@ public:
   float sigma_;
   float rho_;
   float omega_;
-  
+
+  // Convolution from a shared memory tile, radius up to LENIA_MAX_RADIUS
+  boolean shared_memory_;
+  s32 tile_size_;
+
 private:
-  void compileShaders();
+  boolean compileTiledShader(boolean rebuild = false);
   void swap();
 
   TimeCont update_timer_;
   u32 loops_;
 
+  GPUProfiler profiler_;
+  u32 automata_section_;
+
+  KernelTable kernel_;
+
   u32 compute_program_;
+  u32 tiled_program_;
+  s32 tiled_program_size_;
 
   u32 width_, height_;
 
   u32 prev_data_id_, current_data_id_;
+  StagingBuffer staging_;
+
+  ParamBlock param_block_;
+
+  ColorMap color_map_;
 };
 
 #endif /* __LENIA_H__ */
@@ -0,0 +1,104 @@
+#include "engine/engine.h"
+#include "kernel_table.h"
+#include "color_map.h"
+#include "gpu_profiler.h"
+#include "automata.h"
+#include "staging_buffer.h"
+#include "param_block.h"
+
+#ifndef __LENIA_ENSEMBLE_H__
+#define __LENIA_ENSEMBLE_H__ 1
+
+// Growth parameters of one world, laid out as a std430 vec4
+struct EnsembleParams
+{
+  f32 mu_;
+  f32 sigma_;
+  f32 dt_;
+  f32 padding_;
+};
+
+// Computed on the GPU over every cell of one world
+struct EnsembleStats
+{
+  f32 mass_;
+  f32 variance_;
+  f32 activity_;
+  f32 padding_;
+};
+
+// Many small Lenia worlds packed in one atlas texture, all of them step in a single dispatch
+// The kernel is shared, mu, sigma and dt are per world
+class LeniaEnsemble : public Automata
+{
+public:
+  LeniaEnsemble();
+  // Size of one world, worlds_ has to be set before
+  void init(Math::Vec2 world) override;
+  ~LeniaEnsemble();
+
+  void update() override;
+  void imgui() override;
+
+  void reset() override;
+  void clean() override;
+
+  u32 currentTexture() override;
+  u64 memoryUsage() const override;
+  boolean compileShaders() override;
+  boolean ready() const override;
+
+  // Spreads mu along the atlas columns and sigma along the rows
+  void sweep();
+
+  // Waits for the GPU, only call it when the numbers are needed
+  const std::vector<EnsembleStats> &statistics();
+
+  // The whole atlas, row major like CPUReference, to compare both
+  void setCells(const f32 *cells);
+  void getCells(f32 *cells);
+
+  s32 worlds_;
+  std::vector<EnsembleParams> params_;
+
+  float radius_;
+  float rho_;
+  float omega_;
+
+  // Ranges used by sweep()
+  float mu_min_, mu_max_;
+  float sigma_min_, sigma_max_;
+  float dt_;
+
+private:
+  void uploadParams();
+  void swap();
+
+  TimeCont update_timer_;
+  u32 loops_;
+
+  GPUProfiler profiler_;
+  u32 automata_section_;
+
+  KernelTable kernel_;
+
+  u32 compute_program_, stats_program_;
+  u32 params_ssbo_, stats_ssbo_;
+  std::vector<EnsembleParams> uploaded_params_;
+  std::vector<EnsembleStats> stats_;
+
+  u32 world_width_, world_height_;
+  u32 columns_, rows_;
+  u32 width_, height_;
+
+  s32 selected_world_;
+
+  u32 prev_data_id_, current_data_id_;
+  StagingBuffer staging_;
+
+  ParamBlock param_block_;
+
+  ColorMap color_map_;
+};
+
+#endif /* __LENIA_ENSEMBLE_H__ */
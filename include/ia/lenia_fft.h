@@ -0,0 +1,93 @@
+#include "engine/engine.h"
+#include "fft.h"
+#include "kernel_table.h"
+#include "color_map.h"
+#include "gpu_profiler.h"
+#include "automata.h"
+#include "param_block.h"
+
+#ifndef __LENIA_FFT_H__
+#define __LENIA_FFT_H__ 1
+
+#define FFT_BACKEND_CPU 0
+#define FFT_BACKEND_GPU 1
+
+// Lenia with the convolution done in frequency space, the step cost doesn't depend on the radius
+class LeniaFFT : public Automata
+{
+public:
+  LeniaFFT();
+  void init(Math::Vec2 win) override;
+  ~LeniaFFT();
+
+  void update() override;
+  void imgui() override;
+
+  void reset() override;
+  void clean() override;
+
+  u32 currentTexture() override;
+  u64 memoryUsage() const override;
+  boolean compileShaders() override;
+
+  // GPU lines are transformed in shared memory, power of two sizes up to FFT_MAX_SIZE
+  boolean gpuAvailable() const;
+
+  // One value per cell, row major like CPUReference, to compare both
+  void setCells(const f32 *cells);
+  void getCells(f32 *cells);
+
+  float radius_;
+  float dt_;
+  float mu_;
+  float sigma_;
+  float rho_;
+  float omega_;
+
+  s32 backend_;
+
+private:
+  void buildKernel();
+  void updateCPU();
+  void updateGPU();
+  void dispatchFFT(f32 direction);
+
+  void selectBackend();
+  // False when the GPU programs didn't build
+  boolean initGPU();
+  boolean gpuBuilt() const;
+  void uploadCells();
+  void downloadCells();
+  void swap();
+
+  TimeCont update_timer_;
+  u32 loops_;
+
+  GPUProfiler profiler_;
+  u32 load_section_, forward_section_, multiply_section_, inverse_section_, growth_section_;
+
+  u32 width_, height_;
+
+  KernelTable kernel_;
+  std::vector<Complex> kernel_spectrum_;
+  boolean kernel_uploaded_;
+
+  FFT2D fft_;
+  std::vector<f32> cells_;
+  std::vector<Complex> work_;
+
+  s32 active_backend_;
+  boolean gpu_ready_;
+  boolean texture_dirty_;
+
+  u32 load_program_, fft_program_, multiply_program_, growth_program_;
+  u32 fft_data_ssbo_, fft_kernel_ssbo_;
+
+  u32 prev_data_id_, current_data_id_;
+
+  ParamBlock param_block_;
+
+  ColorMap color_map_;
+};
+
+#endif /* __LENIA_FFT_H__ */
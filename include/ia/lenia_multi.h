@@ -0,0 +1,112 @@
+#include "engine/engine.h"
+#include "defines.h"
+#include "fft.h"
+#include "kernel_table.h"
+#include "color_map.h"
+#include "gpu_profiler.h"
+#include "lenia_fft.h"
+#include "automata.h"
+#include "param_block.h"
+
+#ifndef __LENIA_MULTI_H__
+#define __LENIA_MULTI_H__ 1
+
+// One kernel reads a source channel and adds its growth to a target channel
+struct LeniaKernel
+{
+  s32 source_;
+  s32 target_;
+
+  f32 radius_;
+  f32 rho_;
+  f32 omega_;
+  std::vector<f32> peaks_;
+
+  f32 mu_;
+  f32 sigma_;
+  f32 weight_;
+};
+
+// Lenia with several channels and kernels, every plane is convolved in frequency space
+// Each channel is transformed once and each kernel adds one multiply and one inverse transform
+class LeniaMulti : public Automata
+{
+public:
+  LeniaMulti();
+  void init(Math::Vec2 win) override;
+  ~LeniaMulti();
+
+  void update() override;
+  void imgui() override;
+
+  void reset() override;
+  void clean() override;
+
+  u32 currentTexture() override;
+  u64 memoryUsage() const override;
+  boolean compileShaders() override;
+
+  // Same limits as LeniaFFT, power of two sizes up to FFT_MAX_SIZE
+  boolean gpuAvailable() const;
+
+  // First channel, row major like CPUReference, to compare both. The other channels are cleared
+  void setCells(const f32 *cells);
+  void getCells(f32 *cells);
+
+  // Up to LENIA_MAX_CHANNELS and LENIA_MAX_KERNELS
+  s32 channels_;
+  std::vector<LeniaKernel> kernels_;
+  f32 dt_;
+
+  s32 backend_;
+
+private:
+  void buildKernels();
+  void updateCPU();
+  void updateGPU();
+  void dispatchFFT(f32 direction, u32 planes);
+
+  void selectBackend();
+  // False when the GPU programs didn't build
+  boolean initGPU();
+  boolean gpuBuilt() const;
+  void resizeGPU();
+  void uploadCells();
+  void downloadCells();
+  void swap();
+
+  TimeCont update_timer_;
+  u32 loops_;
+
+  GPUProfiler profiler_;
+  u32 load_section_, forward_section_, multiply_section_, inverse_section_, growth_section_;
+
+  u32 width_, height_;
+  u32 plane_size_;
+
+  KernelTable tables_[LENIA_MAX_KERNELS];
+  std::vector<Complex> kernel_spectra_;
+  s32 built_kernels_;
+  boolean kernels_uploaded_;
+
+  FFT2D fft_;
+  std::vector<f32> cells_;
+  std::vector<Complex> spectra_;
+  std::vector<Complex> potentials_;
+
+  s32 active_backend_;
+  boolean gpu_ready_;
+  boolean texture_dirty_;
+
+  u32 load_program_, fft_program_, multiply_program_, growth_program_;
+  u32 spectra_ssbo_, kernel_ssbo_, potential_ssbo_;
+  u32 gpu_kernels_;
+
+  u32 prev_data_id_, current_data_id_;
+
+  ParamBlock param_block_;
+
+  ColorMap color_map_;
+};
+
+#endif /* __LENIA_MULTI_H__ */
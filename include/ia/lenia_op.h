@@ -1,23 +1,36 @@
 #include "engine/engine.h"
 #include "defines.h"
+#include "kernel_table.h"
+#include "color_map.h"
+#include "gpu_profiler.h"
+#include "automata.h"
+#include "staging_buffer.h"
+#include "param_block.h"
 
 #ifndef __LENIA_OP_H__
 #define __LENIA_OP_H__ 1
 
-class LeniaOp
+class LeniaOp : public Automata
 {
 public:
   LeniaOp();
-  void init(Math::Vec2 win);
+  void init(Math::Vec2 win) override;
   ~LeniaOp();
 
-  void update();
-  void imgui();
+  void update() override;
+  void imgui() override;
 
-  void reset();
-  void clean();
+  void reset() override;
+  void clean() override;
 
-  u32 currentTexture();
+  u32 currentTexture() override;
+  u64 memoryUsage() const override;
+  boolean compileShaders() override;
+  boolean ready() const override;
+
+  // One value per cell, row major like CPUReference, to compare both
+  void setCells(const f32 *cells);
+  void getCells(f32 *cells);
 
   s32 radius_;
   float dt_;
@@ -25,28 +38,29 @@ public:
   float sigma_;
   float rho_;
   float omega_;
-  
+
 private:
-  struct Pixel
-  {
-    u_byte r, g, b, a;
-  };
-  float sumOriginal(Pixel* prev_img, u32 x, u32 y);
-  float sumCounter(Counter* counter, u32 x, u32 y);
-  void checkSingleSlot(Counter* counter, Pixel* prev_img, u32 x, u32 y);
-  void checkComputeResults();
-  void compileShaders();
   void swap();
 
   TimeCont update_timer_;
   u32 loops_;
 
+  GPUProfiler profiler_;
+  u32 counter_section_, automata_section_;
+
+  KernelTable kernel_;
+
   u32 counter_ssbo_;
   u32 pre_compute_program_, compute_program_;
 
   u32 width_, height_;
 
   u32 prev_data_id_, current_data_id_;
+  StagingBuffer staging_;
+
+  ParamBlock param_block_;
+
+  ColorMap color_map_;
 };
 
 #endif /* __LENIA_OP_H__ */
@@ -0,0 +1,40 @@
+#include "engine/engine.h"
+
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__ 1
+
+// Same amount of threads that the TaskManager owns
+inline u32 ParallelBands()
+{
+  return std::max(1u, std::thread::hardware_concurrency() / 2);
+}
+
+// Splits [0, count) in bands of a multiple of alignment over the TaskManager and waits for all
+template <typename Function>
+inline void ParallelFor(u32 count, Function &&func, u32 alignment = 1)
+{
+  u32 bands = ParallelBands();
+  if (bands <= 1 || count <= alignment)
+  {
+    func(0u, count);
+    return;
+  }
+
+  u32 per_band = (count + bands - 1) / bands;
+  per_band = (per_band + alignment - 1) / alignment * alignment;
+
+  std::vector<std::future<void>> futures;
+  futures.reserve(bands);
+
+  for (u32 first = 0; first < count; first += per_band)
+  {
+    u32 last = std::min(first + per_band, count);
+    futures.push_back(TM->enqueue([&func, first, last]()
+                                  { func(first, last); }));
+  }
+
+  for (auto &future : futures)
+    future.wait();
+}
+
+#endif /* __PARALLEL_H__ */
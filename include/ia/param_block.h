@@ -0,0 +1,30 @@
+#include "engine/engine.h"
+
+#ifndef __PARAM_BLOCK_H__
+#define __PARAM_BLOCK_H__ 1
+
+// Uniform buffer of one engine, the programs read it from the same binding instead of per dispatch uniforms
+class ParamBlock
+{
+public:
+  ParamBlock();
+  ~ParamBlock();
+
+  // Uploads the std140 struct only when it differs from the last upload and binds it
+  template <typename T>
+  void bind(u32 binding, const T &params)
+  {
+    bind(binding, &params, sizeof(T));
+  }
+
+  // Uploads since the program started, the rest of the generations reuse the buffer
+  static u32 Uploads();
+
+private:
+  void bind(u32 binding, const void *params, size_t size);
+
+  u32 ubo_;
+  std::vector<u_byte> uploaded_;
+};
+
+#endif /* __PARAM_BLOCK_H__ */
@@ -0,0 +1,42 @@
+#include "engine/engine.h"
+
+#ifndef __PROGRAM_BATCH_H__
+#define __PROGRAM_BATCH_H__ 1
+
+#define PROGRAM_CACHE_DIR "program_cache/"
+
+// Compute programs of one engine built together
+// With GL_KHR_parallel_shader_compile the driver compiles all of them at the same time, and the
+// linked binaries are kept in PROGRAM_CACHE_DIR keyed by the source and driver for the next launch
+class ProgramBatch
+{
+public:
+  ProgramBatch();
+  ~ProgramBatch();
+
+  // Starts the build, the source already has every define
+  void add(u32 *program, const std::string &source, const char *name);
+
+  // Waits for every program, the ones that fail print their log and keep the previous id
+  // Returns false when any failed
+  boolean finish();
+
+  // Programs loaded from the cache and compiled since launch
+  static u32 CacheHits();
+  static u32 CacheMisses();
+
+private:
+  struct Entry
+  {
+    u32 *target_;
+    const char *name_;
+    std::string path_;
+    u32 shader_;
+    u32 program_;
+    boolean cached_;
+  };
+
+  std::vector<Entry> entries_;
+};
+
+#endif /* __PROGRAM_BATCH_H__ */
@@ -0,0 +1,58 @@
+#include "engine/engine.h"
+
+#ifndef __SEED_H__
+#define __SEED_H__ 1
+
+// Range of SeedConfig::scale_, the patterns clamp it
+#define SEED_MIN_SCALE 1.0f
+#define SEED_MAX_SCALE 1024.0f
+
+enum class SeedPattern
+{
+  Noise,
+  Blobs,
+  Soup
+};
+
+struct SeedConfig
+{
+  u32 seed_ = 1;
+  SeedPattern pattern_ = SeedPattern::Noise;
+
+  // Alive chance of binary noise, covered area for blobs and soup
+  f32 density_ = 0.4f;
+  // Blob radius and half the side of the soup squares, in cells (SEED_MIN_SCALE to SEED_MAX_SCALE)
+  f32 scale_ = 16.0f;
+};
+
+// Initial states from a counter based hash, every cell only depends on (seed, stream, x, y)
+// so the same seed gives the same state on any amount of threads and in any engine
+class Seeder
+{
+public:
+  // Writes width x height cells, stride is the row length of cells (0 means width)
+  // Binary engines get 0 or 1, the continuous ones a value in [0, 1)
+  static void Fill(const SeedConfig &config, u32 width, u32 height, boolean binary, f32 *cells, u32 stream = 0, u32 stride = 0);
+
+  // Same binary cells packed 32 per word, (width + 31) / 32 words per row and bit x % 32 is column x
+  static void FillBits(const SeedConfig &config, u32 width, u32 height, u32 *words, u32 stream = 0);
+
+  // Same binary cells one byte each, 0 or 255 for the R8 state textures
+  static void FillBytes(const SeedConfig &config, u32 width, u32 height, u_byte *cells, u32 stream = 0);
+
+  // Uniform value in [0, 1)
+  static f32 Random(u32 seed, u32 stream, u32 counter);
+  static u32 Hash(u32 value);
+
+  // Seed widgets for the engine window, true when the state has to be generated again
+  static boolean Imgui(SeedConfig &config);
+
+  static const byte *PatternName(SeedPattern pattern);
+  static boolean ParsePattern(const byte *name, SeedPattern &pattern);
+
+private:
+  Seeder();
+  ~Seeder();
+};
+
+#endif /* __SEED_H__ */
@@ -0,0 +1,34 @@
+#include "engine/engine.h"
+
+#ifndef __STAGING_BUFFER_H__
+#define __STAGING_BUFFER_H__ 1
+
+// Persistent mapped pixel unpack buffer, the memory is allocated once and reused by every upload
+// A fence keeps the CPU from writing while the GPU still reads the last upload
+class StagingBuffer
+{
+public:
+  StagingBuffer();
+  ~StagingBuffer();
+
+  // Mapped memory of at least size bytes, only grows
+  void *map(size_t size);
+
+  // Single channel upload of the mapped values (type GL_UNSIGNED_BYTE or GL_FLOAT)
+  void upload(u32 texture, u32 width, u32 height, u32 type);
+
+  // First size mapped bytes into the start of a buffer object
+  void copy(u32 buffer, size_t size);
+
+  size_t size() const;
+
+private:
+  void wait();
+
+  u32 pbo_;
+  size_t size_;
+  void *memory_;
+  GLsync fence_;
+};
+
+#endif /* __STAGING_BUFFER_H__ */
@@ -0,0 +1,590 @@
+#include <engine/engine.h>
+#include <bit>
+#include "ia/ia.h"
+#include "ia/gpu_helper.h"
+#include "ia/program_batch.h"
+#include "headless/gl_context.h"
+
+// Runs every engine next to its CPUReference from the same seeded cells
+// and reports the error of each generation, the exit code says if any case went over its tolerance
+
+struct ConformanceConfig
+{
+  u32 generations_ = 20;
+  u32 width_ = 96;
+  u32 height_ = 64;
+  u32 seed_ = 1;
+
+  // Max absolute error allowed for the continuous automatas, the binary ones need an exact match
+  f32 tolerance_ = 1.0f / 64.0f;
+
+  // Growth of the Lenia cases, the engine defaults kill random noise in a few generations
+  f32 mu_ = 0.3f;
+  f32 sigma_ = 0.05f;
+
+  // Radius of the cases that have one, 0 keeps the engine default
+  f32 radius_ = 0.0f;
+  // Every integer radius of the engine slider instead
+  boolean sweep_ = false;
+
+  // Only the case with this name, empty runs all
+  std::string case_;
+};
+
+// Cells of one case, the seed fills the grid but a margin that starts empty
+struct CaseGrid
+{
+  u32 width_ = 0;
+  u32 height_ = 0;
+  u32 margin_ = 0;
+
+  Math::Vec2 size() const { return Math::Vec2(static_cast<f32>(width_), static_cast<f32>(height_)); }
+};
+
+struct CaseResult
+{
+  f32 max_error_ = 0.0f;
+  u32 first_generation_ = 0;
+  boolean passed_ = true;
+};
+
+static void PrintUsage(const byte *program)
+{
+  fprintf(stdout, "Usage: %s [options]\n", program);
+  fprintf(stdout, "  --case <name>                              Only run one case (default all)\n");
+  fprintf(stdout, "                                             conway, conway_packed, conway_cpu, hashlife, smooth, smooth_table,\n");
+  fprintf(stdout, "                                             lenia, lenia_tiled, lenia_op, lenia_fft_cpu, lenia_fft_gpu,\n");
+  fprintf(stdout, "                                             lenia_multi_cpu, lenia_multi_gpu, lenia_ensemble\n");
+  fprintf(stdout, "  --generations <n>                          Generations per case (default 20)\n");
+  fprintf(stdout, "  --width <n> --height <n>                   Grid size (default 96x64)\n");
+  fprintf(stdout, "  --seed <n>                                 Seed of the initial cells (default 1)\n");
+  fprintf(stdout, "  --tolerance <f>                            Max absolute error of the Lenia cases (default 1/64)\n");
+  fprintf(stdout, "  --mu <f> --sigma <f>                       Growth of the Lenia cases (default 0.3 and 0.05)\n");
+  fprintf(stdout, "  --radius <f>                               Radius of the SmoothLife and Lenia cases (default the engine one)\n");
+  fprintf(stdout, "  --sweep                                    Runs them with every radius of their slider, the halves too but for lenia_op\n");
+}
+
+static boolean ParseArgs(s32 argc, byte *argv[], ConformanceConfig &config)
+{
+  for (s32 i = 1; i < argc; i++)
+  {
+    const byte *arg = argv[i];
+
+    if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+      return false;
+
+    if (strcmp(arg, "--sweep") == 0)
+    {
+      config.sweep_ = true;
+      continue;
+    }
+
+    if (i + 1 >= argc)
+    {
+      fprintf(stderr, "Missing value for %s\n", arg);
+      return false;
+    }
+    const byte *value = argv[++i];
+
+    if (strcmp(arg, "--case") == 0)
+      config.case_ = value;
+    else if (strcmp(arg, "--generations") == 0)
+      config.generations_ = static_cast<u32>(strtoul(value, nullptr, 10));
+    else if (strcmp(arg, "--width") == 0)
+      config.width_ = static_cast<u32>(strtoul(value, nullptr, 10));
+    else if (strcmp(arg, "--height") == 0)
+      config.height_ = static_cast<u32>(strtoul(value, nullptr, 10));
+    else if (strcmp(arg, "--seed") == 0)
+      config.seed_ = static_cast<u32>(strtoul(value, nullptr, 10));
+    else if (strcmp(arg, "--tolerance") == 0)
+      config.tolerance_ = strtof(value, nullptr);
+    else if (strcmp(arg, "--mu") == 0)
+      config.mu_ = strtof(value, nullptr);
+    else if (strcmp(arg, "--sigma") == 0)
+      config.sigma_ = strtof(value, nullptr);
+    else if (strcmp(arg, "--radius") == 0)
+      config.radius_ = strtof(value, nullptr);
+    else
+    {
+      fprintf(stderr, "Unknown option: %s\n", arg);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// The driver picks how floats are rounded into R16F, the reference has to do the same
+static ReferencePrecision ProbeHalfRounding()
+{
+  u32 texture = GPUHelper::CreateStateTexture(1, 1, CONTINUOUS_STATE_FORMAT);
+
+  u32 probe_program = 0;
+  ProgramBatch batch;
+  std::string probe_string = defines + GPUHelper::GridDefines(1, 1) + LoadSourceFromFile(SHADER("ia/conformance/half_probe_cs.glsl"));
+  batch.add(&probe_program, probe_string, "half probe program");
+  if (!batch.finish())
+  {
+    glDeleteTextures(1, &texture);
+    return ReferencePrecision::HalfNearest;
+  }
+
+  glUseProgram(probe_program);
+  glBindImageTexture(CURR_IMG_BIND, texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, CONTINUOUS_STATE_FORMAT);
+  glDispatchCompute(1, 1, 1);
+  glUseProgram(0);
+
+  f32 value = 0.0f;
+  GPUHelper::DownloadState(texture, GL_FLOAT, &value);
+
+  glDeleteProgram(probe_program);
+  glDeleteTextures(1, &texture);
+
+  return (value > 1.0f) ? ReferencePrecision::HalfNearest : ReferencePrecision::HalfTowardZero;
+}
+
+static std::vector<f32> SeededCells(const ConformanceConfig &config, const CaseGrid &grid, boolean binary)
+{
+  u32 seed_width = grid.width_ - grid.margin_ * 2;
+  u32 seed_height = grid.height_ - grid.margin_ * 2;
+  std::vector<f32> seeded(static_cast<size_t>(seed_width) * seed_height);
+
+  SeedConfig seed;
+  seed.seed_ = config.seed_;
+  Seeder::Fill(seed, seed_width, seed_height, binary, seeded.data());
+
+  std::vector<f32> cells(static_cast<size_t>(grid.width_) * grid.height_, 0.0f);
+  for (u32 y = 0; y < seed_height; y++)
+    std::copy_n(seeded.begin() + static_cast<size_t>(y) * seed_width, seed_width,
+                cells.begin() + static_cast<size_t>(y + grid.margin_) * grid.width_ + grid.margin_);
+
+  return cells;
+}
+
+// ConwayCPU and Hashlife keep RGBA cells, alive when the alpha is over 127
+template <typename T>
+struct RGBACells
+{
+  T &engine_;
+  std::vector<u_byte> rgba_;
+
+  RGBACells(T &engine, const CaseGrid &grid) : engine_(engine), rgba_(static_cast<size_t>(grid.width_) * grid.height_ * 4) {}
+
+  boolean ready() const { return engine_.ready(); }
+  void update() { engine_.update(); }
+
+  void setCells(const f32 *cells)
+  {
+    for (size_t i = 0; i < rgba_.size() / 4; i++)
+    {
+      u_byte value = (cells[i] > 0.5f) ? 255 : 0;
+      rgba_[i * 4 + 0] = rgba_[i * 4 + 1] = rgba_[i * 4 + 2] = rgba_[i * 4 + 3] = value;
+    }
+    engine_.setCells(rgba_.data());
+  }
+
+  void getCells(f32 *cells)
+  {
+    engine_.getCells(rgba_.data());
+    for (size_t i = 0; i < rgba_.size() / 4; i++)
+      cells[i] = (rgba_[i * 4 + 3] > 127) ? 1.0f : 0.0f;
+  }
+};
+
+// Copies the Lenia parameters of the engine, the radius truncated for LeniaOp
+template <typename T>
+static void MatchLenia(const T &engine, CPUReference &reference)
+{
+  reference.radius_ = static_cast<f32>(engine.radius_);
+  reference.dt_ = engine.dt_;
+  reference.mu_ = engine.mu_;
+  reference.sigma_ = engine.sigma_;
+  reference.rho_ = engine.rho_;
+  reference.omega_ = engine.omega_;
+}
+
+// The --radius one, the slider radii every step with --sweep or the engine default
+// Engines with a float radius sweep the halves too, a truncated radius would step another kernel
+static std::vector<f32> Radii(const ConformanceConfig &config, f32 engine_radius, s32 slider_min, s32 slider_max, f32 step)
+{
+  if (config.sweep_)
+  {
+    std::vector<f32> radii;
+    for (f32 radius = static_cast<f32>(slider_min); radius <= static_cast<f32>(slider_max); radius += step)
+      radii.push_back(radius);
+    return radii;
+  }
+
+  return {(config.radius_ > 0.0f) ? config.radius_ : engine_radius};
+}
+
+static std::string CaseName(const byte *name, f32 radius)
+{
+  byte suffix[32];
+  snprintf(suffix, sizeof(suffix), " r%g", radius);
+  return std::string(name) + suffix;
+}
+
+// The GPU FFT needs power of two sizes, other grids run on the next ones
+static CaseGrid FFTGrid(const ConformanceConfig &config, const byte *name)
+{
+  CaseGrid grid;
+  grid.width_ = std::min(std::bit_ceil(config.width_), static_cast<u32>(FFT_MAX_SIZE));
+  grid.height_ = std::min(std::bit_ceil(config.height_), static_cast<u32>(FFT_MAX_SIZE));
+
+  if (grid.width_ != config.width_ || grid.height_ != config.height_)
+    fprintf(stdout, "%s - Runs on %ux%u, the GPU transform needs power of two sizes\n", name, grid.width_, grid.height_);
+
+  return grid;
+}
+
+// With resync the reference restarts from the engine cells every generation, so the error of one step
+// is measured instead of the whole run
+template <typename T>
+static CaseResult RunCase(const std::string &case_name, T &engine, CPUReference &reference, const ConformanceConfig &config,
+                          const CaseGrid &grid, f32 tolerance, boolean resync = false)
+{
+  CaseResult result;
+  const byte *name = case_name.c_str();
+
+  if (!engine.ready())
+  {
+    fprintf(stdout, "%s: FAIL - The programs didn't build\n", name);
+    result.passed_ = false;
+    return result;
+  }
+
+  boolean binary = reference.type() == ReferenceType::Conway || reference.type() == ReferenceType::SmoothLife;
+  std::vector<f32> cells = SeededCells(config, grid, binary);
+
+  // The GPU rounds the seed into its state format, the reference starts from the same values
+  engine.setCells(cells.data());
+  engine.getCells(cells.data());
+  reference.setCells(cells.data());
+
+  for (u32 generation = 1; generation <= config.generations_; generation++)
+  {
+    engine.update();
+    reference.update();
+
+    engine.getCells(cells.data());
+    const std::vector<f32> &expected = reference.cells();
+
+    f32 max_error = 0.0f;
+    f64 total_error = 0.0;
+    size_t first_cell = cells.size();
+    for (size_t i = 0; i < cells.size(); i++)
+    {
+      f32 error = std::fabs(cells[i] - expected[i]);
+      total_error += error;
+      max_error = std::max(max_error, error);
+      if (error > 0.0f && first_cell == cells.size())
+        first_cell = i;
+    }
+    f64 mean_error = total_error / static_cast<f64>(cells.size());
+
+    if (max_error > result.max_error_)
+      result.max_error_ = max_error;
+    if (max_error > tolerance && result.passed_)
+    {
+      result.passed_ = false;
+      result.first_generation_ = generation;
+    }
+
+    if (first_cell != cells.size())
+    {
+      u32 x = static_cast<u32>(first_cell % grid.width_);
+      u32 y = static_cast<u32>(first_cell / grid.width_);
+      fprintf(stdout, "%s - Generation %u - Max %.6e Mean %.6e - First (%u, %u) GPU %.6f CPU %.6f\n",
+              name, generation, max_error, mean_error, x, y, cells[first_cell], expected[first_cell]);
+    }
+    else
+    {
+      fprintf(stdout, "%s - Generation %u - Exact\n", name, generation);
+    }
+
+    if (resync)
+      reference.setCells(cells.data());
+  }
+
+  if (result.passed_)
+    fprintf(stdout, "%s: PASS - Max error %.6e (Tolerance %.6e)\n", name, result.max_error_, tolerance);
+  else
+    fprintf(stdout, "%s: FAIL - Max error %.6e (Tolerance %.6e) first over it at generation %u\n", name, result.max_error_, tolerance, result.first_generation_);
+
+  return result;
+}
+
+static boolean Selected(const ConformanceConfig &config, const byte *name)
+{
+  return config.case_.empty() || config.case_ == name;
+}
+
+s32 main(s32 argc, byte *argv[])
+{
+  ConformanceConfig config;
+  if (!ParseArgs(argc, argv, config))
+  {
+    PrintUsage(argv[0]);
+    return -1;
+  }
+
+  if (config.width_ == 0 || config.height_ == 0)
+  {
+    fprintf(stderr, "Invalid grid size: %ux%u\n", config.width_, config.height_);
+    return -1;
+  }
+
+  if (!CreateContext())
+    return -1;
+
+  Math::Vec2 size = Math::Vec2(static_cast<f32>(config.width_), static_cast<f32>(config.height_));
+
+  ReferencePrecision precision = ProbeHalfRounding();
+  fprintf(stdout, "Renderer: %s - R16F rounds %s\n", glGetString(GL_RENDERER),
+          (precision == ReferencePrecision::HalfNearest) ? "to nearest" : "toward zero");
+  fprintf(stdout, "Grid %ux%u - %u generations - Seed %u%s\n", config.width_, config.height_, config.generations_, config.seed_,
+          config.sweep_ ? " - Every slider radius" : "");
+
+  boolean passed = true;
+  u32 cases = 0;
+
+  CaseGrid grid;
+  grid.width_ = config.width_;
+  grid.height_ = config.height_;
+
+  if (Selected(config, "conway"))
+  {
+    Conway conway;
+    conway.init(size);
+    CPUReference reference(ReferenceType::Conway);
+    reference.init(size);
+    passed &= RunCase("conway", conway, reference, config, grid, 0.0f).passed_;
+    cases++;
+  }
+
+  if (Selected(config, "conway_packed"))
+  {
+    ConwayPacked conway_packed;
+    conway_packed.init(size);
+    CPUReference reference(ReferenceType::Conway);
+    reference.init(size);
+    passed &= RunCase("conway_packed", conway_packed, reference, config, grid, 0.0f).passed_;
+    cases++;
+  }
+
+  if (Selected(config, "conway_cpu"))
+  {
+    ConwayCPU conway_cpu;
+    conway_cpu.init(size);
+    RGBACells<ConwayCPU> cells(conway_cpu, grid);
+    CPUReference reference(ReferenceType::Conway);
+    reference.init(size);
+    passed &= RunCase("conway_cpu", cells, reference, config, grid, 0.0f).passed_;
+    cases++;
+  }
+
+  // The plane is infinite, an empty margin wider than the generations keeps the torus of the reference from mattering
+  if (Selected(config, "hashlife"))
+  {
+    CaseGrid plane;
+    plane.margin_ = config.generations_ + 1;
+    plane.width_ = config.width_ + plane.margin_ * 2;
+    plane.height_ = config.height_ + plane.margin_ * 2;
+
+    Hashlife hashlife;
+    hashlife.init(plane.size());
+    hashlife.step_ = 0;
+    RGBACells<Hashlife> cells(hashlife, plane);
+    CPUReference reference(ReferenceType::Conway);
+    reference.init(plane.size());
+    passed &= RunCase("hashlife", cells, reference, config, plane, 0.0f).passed_;
+    cases++;
+  }
+
+  if (Selected(config, "smooth") || Selected(config, "smooth_table"))
+  {
+    SmoothLife smooth_life;
+    smooth_life.init(size);
+    CPUReference reference(ReferenceType::SmoothLife);
+    reference.init(size);
+
+    for (f32 radius : Radii(config, smooth_life.radius_, 4, 32, 0.5f))
+    {
+      smooth_life.radius_ = reference.radius_ = radius;
+
+      if (Selected(config, "smooth"))
+      {
+        smooth_life.summed_area_ = false;
+        passed &= RunCase(CaseName("smooth", radius), smooth_life, reference, config, grid, 0.0f).passed_;
+        cases++;
+      }
+
+      // The table builds the same disk out of rectangles
+      if (Selected(config, "smooth_table"))
+      {
+        smooth_life.summed_area_ = true;
+        passed &= RunCase(CaseName("smooth_table", radius), smooth_life, reference, config, grid, 0.0f).passed_;
+        cases++;
+      }
+    }
+  }
+
+  if (Selected(config, "lenia") || Selected(config, "lenia_tiled"))
+  {
+    Lenia lenia;
+    lenia.init(size);
+    CPUReference reference(ReferenceType::Lenia);
+    reference.init(size);
+    reference.precision_ = precision;
+    lenia.mu_ = config.mu_;
+    lenia.sigma_ = config.sigma_;
+
+    for (f32 radius : Radii(config, lenia.radius_, 10, 25, 0.5f))
+    {
+      lenia.radius_ = radius;
+      MatchLenia(lenia, reference);
+
+      if (Selected(config, "lenia"))
+      {
+        lenia.shared_memory_ = false;
+        passed &= RunCase(CaseName("lenia", radius), lenia, reference, config, grid, config.tolerance_).passed_;
+        cases++;
+      }
+
+      // Same weights added in another order
+      if (Selected(config, "lenia_tiled"))
+      {
+        lenia.shared_memory_ = true;
+        passed &= RunCase(CaseName("lenia_tiled", radius), lenia, reference, config, grid, config.tolerance_).passed_;
+        cases++;
+      }
+    }
+  }
+
+  if (Selected(config, "lenia_op"))
+  {
+    LeniaOp lenia_op;
+    lenia_op.init(size);
+    CPUReference reference(ReferenceType::LeniaOp);
+    reference.init(size);
+    reference.precision_ = precision;
+    lenia_op.mu_ = config.mu_;
+    lenia_op.sigma_ = config.sigma_;
+
+    for (f32 radius : Radii(config, static_cast<f32>(lenia_op.radius_), 10, MAX_RADIUS, 1.0f))
+    {
+      lenia_op.radius_ = std::clamp(static_cast<s32>(radius), 1, MAX_RADIUS);
+      MatchLenia(lenia_op, reference);
+      passed &= RunCase(CaseName("lenia_op", static_cast<f32>(lenia_op.radius_)), lenia_op, reference, config, grid, config.tolerance_).passed_;
+      cases++;
+    }
+  }
+
+  // The CPU transform keeps f32 cells, the GPU one R16F like the other shaders
+  // Transforms round other than the direct sums, one flipped half float grows over the tolerance in a few
+  // generations of these growths, so each step is checked on its own
+  for (s32 backend : {FFT_BACKEND_CPU, FFT_BACKEND_GPU})
+  {
+    const byte *name = (backend == FFT_BACKEND_GPU) ? "lenia_fft_gpu" : "lenia_fft_cpu";
+    if (!Selected(config, name))
+      continue;
+
+    CaseGrid fft_grid = (backend == FFT_BACKEND_GPU) ? FFTGrid(config, name) : grid;
+
+    LeniaFFT lenia_fft;
+    lenia_fft.init(fft_grid.size());
+    lenia_fft.backend_ = backend;
+    CPUReference reference(ReferenceType::Lenia);
+    reference.init(fft_grid.size());
+    reference.precision_ = (backend == FFT_BACKEND_GPU) ? precision : ReferencePrecision::Float;
+    lenia_fft.mu_ = config.mu_;
+    lenia_fft.sigma_ = config.sigma_;
+
+    for (f32 radius : Radii(config, lenia_fft.radius_, 10, 25, 0.5f))
+    {
+      lenia_fft.radius_ = radius;
+      MatchLenia(lenia_fft, reference);
+      passed &= RunCase(CaseName(name, radius), lenia_fft, reference, config, fft_grid, config.tolerance_, true).passed_;
+      cases++;
+    }
+
+    // Without its programs the GPU backend steps on the CPU
+    if (lenia_fft.backend_ != backend)
+    {
+      fprintf(stdout, "%s: FAIL - The GPU programs didn't build\n", name);
+      passed = false;
+    }
+  }
+
+  // One channel and one kernel with a single peak is plain Lenia, checked step by step like LeniaFFT
+  for (s32 backend : {FFT_BACKEND_CPU, FFT_BACKEND_GPU})
+  {
+    const byte *name = (backend == FFT_BACKEND_GPU) ? "lenia_multi_gpu" : "lenia_multi_cpu";
+    if (!Selected(config, name))
+      continue;
+
+    CaseGrid fft_grid = (backend == FFT_BACKEND_GPU) ? FFTGrid(config, name) : grid;
+
+    LeniaMulti lenia_multi;
+    lenia_multi.init(fft_grid.size());
+    lenia_multi.backend_ = backend;
+    lenia_multi.channels_ = 1;
+    CPUReference reference(ReferenceType::Lenia);
+    reference.init(fft_grid.size());
+    reference.precision_ = (backend == FFT_BACKEND_GPU) ? precision : ReferencePrecision::Float;
+    reference.mu_ = config.mu_;
+    reference.sigma_ = config.sigma_;
+    lenia_multi.dt_ = reference.dt_;
+
+    for (f32 radius : Radii(config, reference.radius_, 10, 25, 0.5f))
+    {
+      reference.radius_ = radius;
+      lenia_multi.kernels_ = {LeniaKernel{0, 0, radius, reference.rho_, reference.omega_, {1.0f}, reference.mu_, reference.sigma_, 1.0f}};
+      passed &= RunCase(CaseName(name, radius), lenia_multi, reference, config, fft_grid, config.tolerance_, true).passed_;
+      cases++;
+    }
+
+    if (lenia_multi.backend_ != backend)
+    {
+      fprintf(stdout, "%s: FAIL - The GPU programs didn't build\n", name);
+      passed = false;
+    }
+  }
+
+  // A single world fills the atlas
+  if (Selected(config, "lenia_ensemble"))
+  {
+    LeniaEnsemble lenia_ensemble;
+    lenia_ensemble.worlds_ = 1;
+    lenia_ensemble.mu_min_ = lenia_ensemble.mu_max_ = config.mu_;
+    lenia_ensemble.sigma_min_ = lenia_ensemble.sigma_max_ = config.sigma_;
+    lenia_ensemble.init(size);
+    CPUReference reference(ReferenceType::Lenia);
+    reference.init(size);
+    reference.precision_ = precision;
+    reference.dt_ = lenia_ensemble.dt_;
+    reference.mu_ = config.mu_;
+    reference.sigma_ = config.sigma_;
+    reference.rho_ = lenia_ensemble.rho_;
+    reference.omega_ = lenia_ensemble.omega_;
+
+    for (f32 radius : Radii(config, lenia_ensemble.radius_, 10, LENIA_MAX_RADIUS, 0.5f))
+    {
+      lenia_ensemble.radius_ = reference.radius_ = radius;
+      passed &= RunCase(CaseName("lenia_ensemble", radius), lenia_ensemble, reference, config, grid, config.tolerance_).passed_;
+      cases++;
+    }
+  }
+
+  DestroyContext();
+
+  if (cases == 0)
+  {
+    fprintf(stderr, "Unknown case: %s\n", config.case_.c_str());
+    return -1;
+  }
+
+  fprintf(stdout, "%s\n", passed ? "All cases passed" : "Some cases failed");
+  return passed ? 0 : 1;
+}
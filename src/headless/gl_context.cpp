@@ -0,0 +1,128 @@
+#include "headless/gl_context.h"
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// GL context without window
+///////////////////////////////////////////////////////////////////////////////
+#ifdef __linux__
+static EGLDisplay egl_display = EGL_NO_DISPLAY;
+static EGLContext egl_context = EGL_NO_CONTEXT;
+
+boolean CreateContext()
+{
+  // llvmpipe stops at GL 4.5 but compiles our 460 compute shaders fine
+  setenv("MESA_GL_VERSION_OVERRIDE", "4.6", 0);
+  setenv("MESA_GLSL_VERSION_OVERRIDE", "460", 0);
+
+  PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+  if (get_platform_display)
+    egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+  if (egl_display == EGL_NO_DISPLAY)
+    egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  EGLint major, minor;
+  if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, &major, &minor))
+  {
+    fprintf(stderr, "EGL: Unable to initialize a display\n");
+    return false;
+  }
+
+  if (!eglBindAPI(EGL_OPENGL_API))
+  {
+    fprintf(stderr, "EGL: OpenGL API not available\n");
+    return false;
+  }
+
+  const EGLint context_attribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION, 4,
+      EGL_CONTEXT_MINOR_VERSION, 3,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+      EGL_NONE};
+
+  egl_context = eglCreateContext(egl_display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, context_attribs);
+  if (egl_context == EGL_NO_CONTEXT)
+  {
+    fprintf(stderr, "EGL: Unable to create a GL 4.3 context (0x%x)\n", eglGetError());
+    return false;
+  }
+
+  if (!eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context))
+  {
+    fprintf(stderr, "EGL: Surfaceless context not supported (0x%x)\n", eglGetError());
+    return false;
+  }
+
+  glewExperimental = GL_TRUE;
+  GLenum glew_status = glewInit();
+  // GLX GLEW builds complain about the missing X display once the GL entry points are loaded
+  if (glew_status != GLEW_OK && glew_status != GLEW_ERROR_NO_GLX_DISPLAY)
+  {
+    fprintf(stderr, "GLEW: %s\n", glewGetErrorString(glew_status));
+    return false;
+  }
+
+  return true;
+}
+
+void DestroyContext()
+{
+  if (egl_display == EGL_NO_DISPLAY)
+    return;
+
+  eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (egl_context != EGL_NO_CONTEXT)
+    eglDestroyContext(egl_display, egl_context);
+  eglTerminate(egl_display);
+
+  egl_context = EGL_NO_CONTEXT;
+  egl_display = EGL_NO_DISPLAY;
+}
+#else
+static GLFWwindow *hidden_window = nullptr;
+
+boolean CreateContext()
+{
+  if (!glfwInit())
+    return false;
+
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+  hidden_window = glfwCreateWindow(1, 1, "GPU Automata headless", nullptr, nullptr);
+  if (!hidden_window)
+  {
+    fprintf(stderr, "GLFW: Unable to create a hidden window\n");
+    glfwTerminate();
+    return false;
+  }
+  glfwMakeContextCurrent(hidden_window);
+
+  glewExperimental = GL_TRUE;
+  GLenum glew_status = glewInit();
+  if (glew_status != GLEW_OK)
+  {
+    fprintf(stderr, "GLEW: %s\n", glewGetErrorString(glew_status));
+    return false;
+  }
+
+  return true;
+}
+
+void DestroyContext()
+{
+  if (!hidden_window)
+    return;
+
+  glfwDestroyWindow(hidden_window);
+  glfwTerminate();
+  hidden_window = nullptr;
+}
+#endif
+///////////////////////////////////////////////////////////////////////////////
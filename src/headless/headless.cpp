@@ -0,0 +1,657 @@
+#include <engine/engine.h>
+#include "ia/ia.h"
+#include "ia/backends.h"
+#include "headless/gl_context.h"
+
+enum class Backend
+{
+  Auto = 0,
+  GL,
+  CPU,
+  Calibrate,
+  Named
+};
+
+struct HeadlessConfig
+{
+  s32 mode_ = 0;
+  u64 generations_ = 1000;
+  u32 width_ = C_WIDTH;
+  u32 height_ = C_HEIGHT;
+  u32 report_every_ = 0;
+  s32 step_ = 10;
+  Backend backend_ = Backend::Auto;
+  const byte *backend_name_ = nullptr;
+
+  // Only used by the Lenia modes, negative keeps the engine default
+  f32 radius_ = -1.0f;
+  f32 dt_ = -1.0f;
+  f32 mu_ = -1.0f;
+  f32 sigma_ = -1.0f;
+  f32 rho_ = -1.0f;
+  f32 omega_ = -1.0f;
+
+  // Lenia shared memory tile, 0 reads the image directly
+  s32 tile_ = -1;
+
+  // SmoothLife disk sums from the summed area table instead of the row spans
+  boolean summed_area_ = false;
+
+  // Multi channel Lenia kernels, 0 keeps the default config
+  s32 kernels_ = 0;
+
+  // Lenia ensemble, 0 or negative ranges keep the defaults
+  s32 worlds_ = 64;
+  f32 mu_range_[2] = {-1.0f, -1.0f};
+  f32 sigma_range_[2] = {-1.0f, -1.0f};
+
+  // Initial state of every engine
+  SeedConfig seed_;
+};
+
+static const char *mode_names[] = {"conway", "smooth", "lenia", "lenia_op", "hashlife", "lenia_fft", "lenia_multi", "lenia_ensemble"};
+const static s32 max_modes = 7;
+
+static void PrintUsage(const byte *program)
+{
+  fprintf(stdout, "Usage: %s [options]\n", program);
+  fprintf(stdout, "  --mode <conway|smooth|lenia|lenia_op|hashlife|lenia_fft|lenia_multi|lenia_ensemble|0-7>  Automata to simulate (default conway)\n");
+  fprintf(stdout, "  --generations <n>                          Generations to simulate (default 1000)\n");
+  fprintf(stdout, "  --width <n> --height <n>                   Grid size (default %dx%d)\n", C_WIDTH, C_HEIGHT);
+  fprintf(stdout, "  --report <n>                               Print progress every n generations\n");
+  fprintf(stdout, "  --backend <auto|gl|cpu|calibrate|name>     Simulation backend (default auto)\n");
+  fprintf(stdout, "                                             Conway, SmoothLife and Lenia take any backend of their rule by name,\n");
+  fprintf(stdout, "                                             auto runs the fastest one and calibrate measures them again\n");
+  fprintf(stdout, "  --step <n>                                 Hashlife jumps 2^n generations per update (0 to %d, default 10)\n", HASHLIFE_MAX_STEP);
+  fprintf(stdout, "  --radius --dt --mu --sigma --rho --omega   Lenia parameters (--radius also SmoothLife)\n");
+  fprintf(stdout, "  --tile <0|8|16|32>                         Lenia shared memory tile (default 16, 0 disables it)\n");
+  fprintf(stdout, "  --sums <spans|table>                       SmoothLife disk sums (default spans)\n");
+  fprintf(stdout, "  --kernels <n>                              Multi channel Lenia kernels (default 6, up to %d)\n", LENIA_MAX_KERNELS);
+  fprintf(stdout, "  --worlds <n>                               Ensemble worlds, --width and --height are one world (default 64)\n");
+  fprintf(stdout, "  --mu-range <min:max> --sigma-range <min:max>  Ensemble sweep, mu along the columns and sigma along the rows\n");
+  fprintf(stdout, "  --seed <n> --pattern <noise|blobs|soup>    Initial state, the same seed gives the same cells (default 1 noise)\n");
+  fprintf(stdout, "  --density <f> --scale <f>                  Alive chance or covered area, blob radius and soup square size\n");
+}
+
+static boolean ParseMode(const byte *value, s32 &mode)
+{
+  for (s32 i = 0; i <= max_modes; i++)
+  {
+    if (strcmp(value, mode_names[i]) == 0)
+    {
+      mode = i;
+      return true;
+    }
+  }
+
+  byte *end = nullptr;
+  long number = strtol(value, &end, 10);
+  if (end == value || *end != '\0' || number < 0 || number > max_modes)
+    return false;
+
+  mode = static_cast<s32>(number);
+  return true;
+}
+
+static boolean ParseArgs(s32 argc, byte *argv[], HeadlessConfig &config)
+{
+  for (s32 i = 1; i < argc; i++)
+  {
+    const byte *arg = argv[i];
+
+    if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+      return false;
+
+    if (i + 1 >= argc)
+    {
+      fprintf(stderr, "Missing value for %s\n", arg);
+      return false;
+    }
+    const byte *value = argv[++i];
+
+    if (strcmp(arg, "--mode") == 0)
+    {
+      if (!ParseMode(value, config.mode_))
+      {
+        fprintf(stderr, "Unknown mode: %s\n", value);
+        return false;
+      }
+    }
+    else if (strcmp(arg, "--generations") == 0)
+      config.generations_ = static_cast<u64>(strtoull(value, nullptr, 10));
+    else if (strcmp(arg, "--width") == 0)
+      config.width_ = static_cast<u32>(strtoul(value, nullptr, 10));
+    else if (strcmp(arg, "--height") == 0)
+      config.height_ = static_cast<u32>(strtoul(value, nullptr, 10));
+    else if (strcmp(arg, "--report") == 0)
+      config.report_every_ = static_cast<u32>(strtoul(value, nullptr, 10));
+    else if (strcmp(arg, "--backend") == 0)
+    {
+      if (strcmp(value, "auto") == 0)
+        config.backend_ = Backend::Auto;
+      else if (strcmp(value, "gl") == 0)
+        config.backend_ = Backend::GL;
+      else if (strcmp(value, "cpu") == 0)
+        config.backend_ = Backend::CPU;
+      else if (strcmp(value, "calibrate") == 0)
+        config.backend_ = Backend::Calibrate;
+      else
+      {
+        config.backend_ = Backend::Named;
+        config.backend_name_ = value;
+      }
+    }
+    else if (strcmp(arg, "--step") == 0)
+      config.step_ = static_cast<s32>(std::clamp(strtol(value, nullptr, 10), 0l, static_cast<long>(HASHLIFE_MAX_STEP)));
+    else if (strcmp(arg, "--radius") == 0)
+      config.radius_ = strtof(value, nullptr);
+    else if (strcmp(arg, "--dt") == 0)
+      config.dt_ = strtof(value, nullptr);
+    else if (strcmp(arg, "--mu") == 0)
+      config.mu_ = strtof(value, nullptr);
+    else if (strcmp(arg, "--sigma") == 0)
+      config.sigma_ = strtof(value, nullptr);
+    else if (strcmp(arg, "--rho") == 0)
+      config.rho_ = strtof(value, nullptr);
+    else if (strcmp(arg, "--omega") == 0)
+      config.omega_ = strtof(value, nullptr);
+    else if (strcmp(arg, "--tile") == 0)
+      config.tile_ = static_cast<s32>(strtol(value, nullptr, 10));
+    else if (strcmp(arg, "--kernels") == 0)
+      config.kernels_ = static_cast<s32>(strtol(value, nullptr, 10));
+    else if (strcmp(arg, "--worlds") == 0)
+      config.worlds_ = static_cast<s32>(strtol(value, nullptr, 10));
+    else if (strcmp(arg, "--mu-range") == 0 || strcmp(arg, "--sigma-range") == 0)
+    {
+      f32 *range = (strcmp(arg, "--mu-range") == 0) ? config.mu_range_ : config.sigma_range_;
+      if (sscanf(value, "%f:%f", &range[0], &range[1]) != 2)
+      {
+        fprintf(stderr, "Invalid range: %s\n", value);
+        return false;
+      }
+    }
+    else if (strcmp(arg, "--seed") == 0)
+      config.seed_.seed_ = static_cast<u32>(strtoul(value, nullptr, 10));
+    else if (strcmp(arg, "--pattern") == 0)
+    {
+      if (!Seeder::ParsePattern(value, config.seed_.pattern_))
+      {
+        fprintf(stderr, "Unknown pattern: %s\n", value);
+        return false;
+      }
+    }
+    else if (strcmp(arg, "--density") == 0)
+      config.seed_.density_ = std::clamp(strtof(value, nullptr), 0.0f, 1.0f);
+    else if (strcmp(arg, "--scale") == 0)
+      config.seed_.scale_ = std::clamp(strtof(value, nullptr), SEED_MIN_SCALE, SEED_MAX_SCALE);
+    else if (strcmp(arg, "--sums") == 0)
+    {
+      if (strcmp(value, "spans") == 0)
+        config.summed_area_ = false;
+      else if (strcmp(value, "table") == 0)
+        config.summed_area_ = true;
+      else
+      {
+        fprintf(stderr, "Unknown sums: %s\n", value);
+        return false;
+      }
+    }
+    else
+    {
+      fprintf(stderr, "Unknown option: %s\n", arg);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <typename T>
+static void ApplyLeniaParams(T &engine, const HeadlessConfig &config)
+{
+  if (config.radius_ > 0.0f)
+    engine.radius_ = static_cast<decltype(engine.radius_)>(config.radius_);
+  if (config.dt_ > 0.0f)
+    engine.dt_ = config.dt_;
+  if (config.mu_ > 0.0f)
+    engine.mu_ = config.mu_;
+  if (config.sigma_ > 0.0f)
+    engine.sigma_ = config.sigma_;
+  if (config.rho_ > 0.0f)
+    engine.rho_ = config.rho_;
+  if (config.omega_ > 0.0f)
+    engine.omega_ = config.omega_;
+}
+
+// Extra kernels repeat the default ones, only the cost matters here
+static void ApplyMultiParams(LeniaMulti &engine, const HeadlessConfig &config)
+{
+  if (config.dt_ > 0.0f)
+    engine.dt_ = config.dt_;
+
+  if (config.kernels_ <= 0)
+    return;
+
+  std::vector<LeniaKernel> kernels = engine.kernels_;
+  engine.kernels_.clear();
+  for (s32 k = 0; k < std::min(config.kernels_, LENIA_MAX_KERNELS); k++)
+    engine.kernels_.push_back(kernels[static_cast<size_t>(k) % kernels.size()]);
+}
+
+static void ApplyEnsembleParams(LeniaEnsemble &engine, const HeadlessConfig &config)
+{
+  if (config.radius_ > 0.0f)
+    engine.radius_ = config.radius_;
+  if (config.rho_ > 0.0f)
+    engine.rho_ = config.rho_;
+  if (config.omega_ > 0.0f)
+    engine.omega_ = config.omega_;
+  if (config.dt_ > 0.0f)
+    engine.dt_ = config.dt_;
+
+  if (config.mu_range_[0] > 0.0f && config.mu_range_[1] > 0.0f)
+  {
+    engine.mu_min_ = config.mu_range_[0];
+    engine.mu_max_ = config.mu_range_[1];
+  }
+  if (config.sigma_range_[0] > 0.0f && config.sigma_range_[1] > 0.0f)
+  {
+    engine.sigma_min_ = config.sigma_range_[0];
+    engine.sigma_max_ = config.sigma_range_[1];
+  }
+
+  engine.sweep();
+}
+
+template <typename T>
+static void ApplySeed(T &engine, const HeadlessConfig &config)
+{
+  engine.seed_ = config.seed_;
+  engine.reset();
+}
+
+// Negative when the engine can't step
+template <typename T>
+static f64 RunEngine(T &engine, const HeadlessConfig &config, boolean wait_gpu)
+{
+  if (!engine.ready())
+  {
+    fprintf(stderr, "The programs of the engine didn't build\n");
+    return -1.0;
+  }
+
+  ApplySeed(engine, config);
+
+  TimeCont timer;
+  TimeCont report_timer;
+  timer.startTime();
+  report_timer.startTime();
+
+  for (u64 generation = 1; generation <= config.generations_; generation++)
+  {
+    engine.update();
+
+    if (config.report_every_ != 0 && generation % config.report_every_ == 0)
+    {
+      report_timer.stopTime();
+      f64 seconds = static_cast<f64>(report_timer.getElapsedTime(TimeCont::Precision::microseconds)) / 1e6;
+      fprintf(stdout, "Generation %llu - %.2f gen/s\n", static_cast<unsigned long long>(generation), static_cast<f64>(config.report_every_) / seconds);
+      report_timer.startTime();
+    }
+  }
+
+  if (wait_gpu)
+    glFinish();
+  timer.stopTime();
+
+  return static_cast<f64>(timer.getElapsedTime(TimeCont::Precision::microseconds)) / 1e6;
+}
+
+static f64 RunGL(const HeadlessConfig &config, Math::Vec2 size)
+{
+  f64 seconds = 0.0;
+
+  if (config.mode_ == 0)
+  {
+    Conway conway;
+    conway.init(size);
+    seconds = RunEngine(conway, config, true);
+  }
+
+  if (config.mode_ == 1)
+  {
+    SmoothLife smooth_life;
+    smooth_life.init(size);
+    if (config.radius_ > 0.0f)
+      smooth_life.radius_ = config.radius_;
+    smooth_life.summed_area_ = config.summed_area_;
+    seconds = RunEngine(smooth_life, config, true);
+  }
+
+  if (config.mode_ == 2)
+  {
+    Lenia lenia;
+    lenia.init(size);
+    ApplyLeniaParams(lenia, config);
+    if (config.tile_ == 0)
+      lenia.shared_memory_ = false;
+    else if (config.tile_ > 0)
+      lenia.tile_size_ = config.tile_;
+    seconds = RunEngine(lenia, config, true);
+  }
+
+  if (config.mode_ == 3)
+  {
+    LeniaOp lenia_op;
+    lenia_op.init(size);
+    ApplyLeniaParams(lenia_op, config);
+    seconds = RunEngine(lenia_op, config, true);
+  }
+
+  if (config.mode_ == 5)
+  {
+    LeniaFFT lenia_fft;
+    lenia_fft.init(size);
+    ApplyLeniaParams(lenia_fft, config);
+    if (lenia_fft.gpuAvailable())
+      lenia_fft.backend_ = FFT_BACKEND_GPU;
+    else
+      fprintf(stderr, "GPU FFT needs power of two sizes up to %d, running on the CPU\n", FFT_MAX_SIZE);
+    seconds = RunEngine(lenia_fft, config, true);
+  }
+
+  if (config.mode_ == 6)
+  {
+    LeniaMulti lenia_multi;
+    lenia_multi.init(size);
+    ApplyMultiParams(lenia_multi, config);
+    if (lenia_multi.gpuAvailable())
+      lenia_multi.backend_ = FFT_BACKEND_GPU;
+    else
+      fprintf(stderr, "GPU FFT needs power of two sizes up to %d, running on the CPU\n", FFT_MAX_SIZE);
+    seconds = RunEngine(lenia_multi, config, true);
+  }
+
+  if (config.mode_ == 7)
+  {
+    LeniaEnsemble lenia_ensemble;
+    lenia_ensemble.worlds_ = config.worlds_;
+    lenia_ensemble.init(size);
+    ApplyEnsembleParams(lenia_ensemble, config);
+    seconds = RunEngine(lenia_ensemble, config, true);
+
+    // One line per world, the sweep results
+    const std::vector<EnsembleStats> &stats = lenia_ensemble.statistics();
+    for (s32 world = 0; world < lenia_ensemble.worlds_; world++)
+    {
+      const EnsembleParams &params = lenia_ensemble.params_[world];
+      fprintf(stdout, "World %d - Mu %.4f Sigma %.4f Dt %.2f - Mass %.4f Variance %.5f Activity %.6f\n",
+              world, params.mu_, params.sigma_, params.dt_, stats[world].mass_, stats[world].variance_, stats[world].activity_);
+    }
+  }
+
+  return seconds;
+}
+
+static f64 RunHashlife(const HeadlessConfig &config, Math::Vec2 size)
+{
+  Hashlife hashlife;
+  hashlife.init(size);
+  ApplySeed(hashlife, config);
+
+  TimeCont timer;
+  timer.startTime();
+
+  u32 updates = 0;
+  while (hashlife.generation() < config.generations_)
+  {
+    // Smaller jumps at the end to land exactly on the requested generation
+    u64 remaining = config.generations_ - hashlife.generation();
+    s32 step = config.step_;
+    while (step > 0 && (1ull << step) > remaining)
+      step--;
+
+    hashlife.step_ = step;
+    hashlife.update();
+    updates++;
+
+    if (config.report_every_ != 0 && updates % config.report_every_ == 0)
+      fprintf(stdout, "Generation %llu - Population %llu\n",
+              static_cast<unsigned long long>(hashlife.generation()),
+              static_cast<unsigned long long>(hashlife.population()));
+  }
+
+  timer.stopTime();
+  fprintf(stdout, "Population: %llu\n", static_cast<unsigned long long>(hashlife.population()));
+
+  return static_cast<f64>(timer.getElapsedTime(TimeCont::Precision::microseconds)) / 1e6;
+}
+
+// Every mode but the ensemble
+static boolean HasCPUBackend(s32 mode)
+{
+  return mode != 7;
+}
+
+static f64 RunCPU(const HeadlessConfig &config, Math::Vec2 size)
+{
+  f64 seconds = 0.0;
+
+  if (config.mode_ == 0)
+  {
+    ConwayCPU conway;
+    conway.init(size);
+    seconds = RunEngine(conway, config, false);
+  }
+
+  // Golden references with the same rules than the shaders
+  if (config.mode_ == 1)
+  {
+    CPUReference smooth_life(ReferenceType::SmoothLife);
+    smooth_life.init(size);
+    if (config.radius_ > 0.0f)
+      smooth_life.radius_ = config.radius_;
+    seconds = RunEngine(smooth_life, config, false);
+  }
+
+  if (config.mode_ == 2 || config.mode_ == 3)
+  {
+    CPUReference lenia((config.mode_ == 2) ? ReferenceType::Lenia : ReferenceType::LeniaOp);
+    lenia.init(size);
+    ApplyLeniaParams(lenia, config);
+    seconds = RunEngine(lenia, config, false);
+  }
+
+  if (config.mode_ == 4)
+    seconds = RunHashlife(config, size);
+
+  if (config.mode_ == 5)
+  {
+    LeniaFFT lenia_fft;
+    lenia_fft.init(size);
+    ApplyLeniaParams(lenia_fft, config);
+    seconds = RunEngine(lenia_fft, config, false);
+  }
+
+  if (config.mode_ == 6)
+  {
+    LeniaMulti lenia_multi;
+    lenia_multi.init(size);
+    ApplyMultiParams(lenia_multi, config);
+    seconds = RunEngine(lenia_multi, config, false);
+  }
+
+  return seconds;
+}
+
+static void PrintSpeed(const HeadlessConfig &config, Math::Vec2 size, f64 seconds)
+{
+  f64 generations_per_second = (seconds > 0.0) ? static_cast<f64>(config.generations_) / seconds : 0.0;
+  f64 cells = static_cast<f64>(size.x) * static_cast<f64>(size.y);
+  if (config.mode_ == 7)
+    cells *= static_cast<f64>(std::clamp(config.worlds_, 1, ENSEMBLE_MAX_WORLDS));
+
+  fprintf(stdout, "Elapsed: %.3f s\n", seconds);
+  fprintf(stdout, "Generations per second: %.2f\n", generations_per_second);
+  fprintf(stdout, "Cell updates per second: %.3e\n", generations_per_second * cells);
+}
+
+// conway, smooth and lenia are the rules in the same order
+static boolean ModeRule(s32 mode, Rule &rule)
+{
+  if (mode > 2)
+    return false;
+
+  rule = static_cast<Rule>(mode);
+  return true;
+}
+
+// Any backend of the rule, without context only the CPU ones
+static s32 RunRule(const HeadlessConfig &config, Rule rule, Math::Vec2 size)
+{
+  boolean gpu = CreateContext();
+  if (gpu)
+    fprintf(stdout, "Renderer: %s\n", glGetString(GL_RENDERER));
+  else
+    fprintf(stderr, "No GL context, only the CPU backends can run\n");
+
+  RuleParams params;
+  params.radius_ = config.radius_;
+  params.dt_ = config.dt_;
+  params.mu_ = config.mu_;
+  params.sigma_ = config.sigma_;
+  params.rho_ = config.rho_;
+  params.omega_ = config.omega_;
+
+  u32 width = static_cast<u32>(size.x);
+  u32 height = static_cast<u32>(size.y);
+
+  const BackendInfo *backend = nullptr;
+  if (config.backend_ == Backend::Named)
+  {
+    backend = Backends::Find(rule, config.backend_name_);
+    f32 radius = Backends::Radius(rule, params);
+    if (backend && (backend->gpu_ && !gpu))
+    {
+      fprintf(stderr, "Backend %s needs a GL context\n", config.backend_name_);
+      backend = nullptr;
+    }
+    else if (backend && !backend->available_(width, height, radius))
+    {
+      fprintf(stderr, "Backend %s can't step a %ux%u grid with radius %.1f\n", config.backend_name_, width, height, radius);
+      backend = nullptr;
+    }
+    else if (!backend)
+    {
+      fprintf(stderr, "Unknown backend %s, %s has:", config.backend_name_, Backends::RuleName(rule));
+      for (const BackendInfo *available : Backends::List(rule, width, height, radius, gpu))
+        fprintf(stderr, " %s", available->name_);
+      fprintf(stderr, "\n");
+    }
+  }
+  else if (config.backend_ == Backend::Calibrate)
+    backend = Backends::Calibrate(rule, width, height, params, gpu);
+  else
+    backend = Backends::Select(rule, width, height, params, gpu);
+
+  if (!backend)
+  {
+    DestroyContext();
+    return -1;
+  }
+
+  fprintf(stdout, "Mode: %s - %ux%u - %llu generations - %s backend\n",
+          mode_names[config.mode_], width, height, static_cast<unsigned long long>(config.generations_), backend->name_);
+
+  f64 seconds = 0.0;
+  {
+    std::unique_ptr<Automata> engine = Backends::Create(*backend, width, height, params);
+    seconds = RunEngine(*engine, config, backend->gpu_);
+  }
+
+  DestroyContext();
+
+  if (seconds < 0.0)
+    return -1;
+
+  PrintSpeed(config, size, seconds);
+
+  return 0;
+}
+
+s32 main(s32 argc, byte *argv[])
+{
+  HeadlessConfig config;
+  if (!ParseArgs(argc, argv, config))
+  {
+    PrintUsage(argv[0]);
+    return -1;
+  }
+
+  if (config.width_ == 0 || config.height_ == 0)
+  {
+    fprintf(stderr, "Invalid grid size: %ux%u\n", config.width_, config.height_);
+    return -1;
+  }
+
+  Math::Vec2 size = Math::Vec2(static_cast<f32>(config.width_), static_cast<f32>(config.height_));
+
+  // --tile and --sums set up the GL engine of the mode
+  Rule rule = Rule::Conway;
+  boolean engine_options = config.tile_ >= 0 || config.summed_area_;
+  if (ModeRule(config.mode_, rule) &&
+      (config.backend_ == Backend::Named || config.backend_ == Backend::Calibrate || (config.backend_ == Backend::Auto && !engine_options)))
+    return RunRule(config, rule, size);
+
+  if (config.backend_ == Backend::Named || config.backend_ == Backend::Calibrate)
+  {
+    fprintf(stderr, "Mode %s has no backend choice, use auto, gl or cpu\n", mode_names[config.mode_]);
+    return -1;
+  }
+
+  Backend backend = config.backend_;
+
+  // Hashlife only runs on the CPU
+  if (config.mode_ == 4)
+    backend = Backend::CPU;
+
+  if (backend != Backend::CPU)
+  {
+    if (CreateContext())
+      backend = Backend::GL;
+    else if (backend == Backend::Auto && HasCPUBackend(config.mode_))
+    {
+      fprintf(stderr, "No GL context, falling back to the CPU backend\n");
+      backend = Backend::CPU;
+    }
+    else
+    {
+      DestroyContext();
+      return -1;
+    }
+  }
+
+  if (backend == Backend::CPU && !HasCPUBackend(config.mode_))
+  {
+    fprintf(stderr, "Mode %s has no CPU backend\n", mode_names[config.mode_]);
+    return -1;
+  }
+
+  if (backend == Backend::GL)
+    fprintf(stdout, "Renderer: %s\n", glGetString(GL_RENDERER));
+
+  fprintf(stdout, "Mode: %s - %ux%u - %llu generations - %s backend\n",
+          mode_names[config.mode_], static_cast<u32>(size.x), static_cast<u32>(size.y),
+          static_cast<unsigned long long>(config.generations_), backend == Backend::GL ? "gl" : "cpu");
+
+  f64 seconds = (backend == Backend::GL) ? RunGL(config, size) : RunCPU(config, size);
+
+  DestroyContext();
+
+  if (seconds < 0.0)
+    return -1;
+
+  PrintSpeed(config, size, seconds);
+
+  return 0;
+}
@@ -0,0 +1,364 @@
+#include "ia/backends.h"
+#include "ia/conway.h"
+#include "ia/conway_cpu.h"
+#include "ia/conway_packed.h"
+#include "ia/cpu_reference.h"
+#include "ia/smooth_life.h"
+#include "ia/lenia.h"
+#include "ia/lenia_op.h"
+#include "ia/lenia_fft.h"
+#include "ia/defines.h"
+
+static const byte *rule_names[] = {"conway", "smooth", "lenia"};
+static const f32 rule_radius[] = {1.0f, O_RADIUS, 15.0f};
+
+// Factories
+///////////////////////////////////////////////////////////////////////////////
+template <typename T>
+static void ApplyLeniaParams(T &engine, const RuleParams &params)
+{
+  if (params.radius_ > 0.0f)
+    engine.radius_ = static_cast<decltype(engine.radius_)>(params.radius_);
+  if (params.dt_ > 0.0f)
+    engine.dt_ = params.dt_;
+  if (params.mu_ > 0.0f)
+    engine.mu_ = params.mu_;
+  if (params.sigma_ > 0.0f)
+    engine.sigma_ = params.sigma_;
+  if (params.rho_ > 0.0f)
+    engine.rho_ = params.rho_;
+  if (params.omega_ > 0.0f)
+    engine.omega_ = params.omega_;
+}
+
+static boolean Always(u32, u32, f32) { return true; }
+
+// Past the corners of the table SmoothLife steps spans, it would be the gpu_spans backend again
+static boolean SmoothTableFits(u32, u32, f32 radius) { return SmoothLife::TableFits(radius); }
+
+// The tiled shader falls back to the direct one past this radius
+static boolean TileFits(u32, u32, f32 radius) { return static_cast<s32>(radius) <= LENIA_MAX_RADIUS; }
+
+// LeniaOp builds its stencil from a whole radius, 12.5 would step the kernel of 12
+static boolean IntegralRadius(u32, u32, f32 radius) { return radius == std::floor(radius); }
+
+static boolean GPUFFTFits(u32 width, u32 height, f32)
+{
+  return FFT::IsPowerOfTwo(width) && FFT::IsPowerOfTwo(height) && width <= FFT_MAX_SIZE && height <= FFT_MAX_SIZE;
+}
+
+static std::unique_ptr<Automata> CreateConway(Math::Vec2 size, const RuleParams &)
+{
+  std::unique_ptr<Conway> engine = std::make_unique<Conway>();
+  engine->init(size);
+  return engine;
+}
+
+static std::unique_ptr<Automata> CreateConwayPacked(Math::Vec2 size, const RuleParams &)
+{
+  std::unique_ptr<ConwayPacked> engine = std::make_unique<ConwayPacked>();
+  engine->init(size);
+  return engine;
+}
+
+static std::unique_ptr<Automata> CreateConwayCPU(Math::Vec2 size, const RuleParams &)
+{
+  std::unique_ptr<ConwayCPU> engine = std::make_unique<ConwayCPU>();
+  engine->init(size);
+  return engine;
+}
+
+static std::unique_ptr<Automata> CreateSmoothLife(Math::Vec2 size, const RuleParams &params, boolean summed_area)
+{
+  std::unique_ptr<SmoothLife> engine = std::make_unique<SmoothLife>();
+  engine->init(size);
+  if (params.radius_ > 0.0f)
+    engine->radius_ = params.radius_;
+  engine->summed_area_ = summed_area;
+  return engine;
+}
+
+static std::unique_ptr<Automata> CreateSmoothSpans(Math::Vec2 size, const RuleParams &params)
+{
+  return CreateSmoothLife(size, params, false);
+}
+
+static std::unique_ptr<Automata> CreateSmoothTable(Math::Vec2 size, const RuleParams &params)
+{
+  return CreateSmoothLife(size, params, true);
+}
+
+static std::unique_ptr<Automata> CreateSmoothCPU(Math::Vec2 size, const RuleParams &params)
+{
+  std::unique_ptr<CPUReference> engine = std::make_unique<CPUReference>(ReferenceType::SmoothLife);
+  engine->init(size);
+  if (params.radius_ > 0.0f)
+    engine->radius_ = params.radius_;
+  return engine;
+}
+
+static std::unique_ptr<Automata> CreateLenia(Math::Vec2 size, const RuleParams &params, boolean shared_memory)
+{
+  std::unique_ptr<Lenia> engine = std::make_unique<Lenia>();
+  engine->init(size);
+  ApplyLeniaParams(*engine, params);
+  engine->shared_memory_ = shared_memory;
+  return engine;
+}
+
+static std::unique_ptr<Automata> CreateLeniaDirect(Math::Vec2 size, const RuleParams &params)
+{
+  return CreateLenia(size, params, false);
+}
+
+static std::unique_ptr<Automata> CreateLeniaTiled(Math::Vec2 size, const RuleParams &params)
+{
+  return CreateLenia(size, params, true);
+}
+
+static std::unique_ptr<Automata> CreateLeniaOp(Math::Vec2 size, const RuleParams &params)
+{
+  std::unique_ptr<LeniaOp> engine = std::make_unique<LeniaOp>();
+  engine->init(size);
+  ApplyLeniaParams(*engine, params);
+  return engine;
+}
+
+static std::unique_ptr<Automata> CreateLeniaFFT(Math::Vec2 size, const RuleParams &params, s32 backend)
+{
+  std::unique_ptr<LeniaFFT> engine = std::make_unique<LeniaFFT>();
+  engine->init(size);
+  ApplyLeniaParams(*engine, params);
+  engine->backend_ = backend;
+  return engine;
+}
+
+static std::unique_ptr<Automata> CreateLeniaFFTGPU(Math::Vec2 size, const RuleParams &params)
+{
+  return CreateLeniaFFT(size, params, FFT_BACKEND_GPU);
+}
+
+static std::unique_ptr<Automata> CreateLeniaFFTCPU(Math::Vec2 size, const RuleParams &params)
+{
+  return CreateLeniaFFT(size, params, FFT_BACKEND_CPU);
+}
+
+// Hashlife isn't here, its updates jump 2^step generations
+static const BackendInfo backends[] = {
+    {"gpu", Rule::Conway, true, &Always, &CreateConway},
+    {"gpu_packed", Rule::Conway, true, &Always, &CreateConwayPacked},
+    {"cpu", Rule::Conway, false, &Always, &CreateConwayCPU},
+    {"gpu_spans", Rule::SmoothLife, true, &Always, &CreateSmoothSpans},
+    {"gpu_table", Rule::SmoothLife, true, &SmoothTableFits, &CreateSmoothTable},
+    {"cpu", Rule::SmoothLife, false, &Always, &CreateSmoothCPU},
+    {"gpu_direct", Rule::Lenia, true, &Always, &CreateLeniaDirect},
+    {"gpu_tiled", Rule::Lenia, true, &TileFits, &CreateLeniaTiled},
+    {"gpu_op", Rule::Lenia, true, &IntegralRadius, &CreateLeniaOp},
+    {"fft_gpu", Rule::Lenia, true, &GPUFFTFits, &CreateLeniaFFTGPU},
+    {"fft_cpu", Rule::Lenia, false, &Always, &CreateLeniaFFTCPU},
+};
+///////////////////////////////////////////////////////////////////////////////
+
+// Cache
+///////////////////////////////////////////////////////////////////////////////
+// FNV-1a of the renderer and the CPU threads, a new driver or machine calibrates again
+static std::string MachineKey(boolean gpu)
+{
+  std::string machine = std::to_string(std::thread::hardware_concurrency()) + "\n";
+  if (gpu)
+  {
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+      const GLubyte *value = glGetString(name);
+      machine += std::string(value ? reinterpret_cast<const byte *>(value) : "") + "\n";
+    }
+  }
+
+  u64 hash = 14695981039346656037ull;
+  for (byte c : machine)
+  {
+    hash ^= static_cast<u_byte>(c);
+    hash *= 1099511628211ull;
+  }
+
+  byte key[32];
+  snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+  return key;
+}
+
+// One line per calibration: machine rule width height radius backend mcs_per_generation
+// The radius is written with every digit of the f32, 12.5 and 12 are different grids
+// The last line of a grid wins
+static const BackendInfo *LoadChoice(Rule rule, u32 width, u32 height, f32 radius, boolean gpu)
+{
+  std::ifstream file(BACKEND_CACHE_FILE);
+  if (!file)
+    return nullptr;
+
+  std::string machine = MachineKey(gpu);
+  const BackendInfo *choice = nullptr;
+
+  std::string line;
+  while (std::getline(file, line))
+  {
+    byte line_machine[32], line_rule[32], line_backend[32];
+    u32 line_width = 0, line_height = 0;
+    f32 line_radius = 0.0f;
+    if (sscanf(line.c_str(), "%31s %31s %u %u %f %31s", line_machine, line_rule, &line_width, &line_height, &line_radius, line_backend) != 6)
+      continue;
+
+    if (machine != line_machine || strcmp(line_rule, Backends::RuleName(rule)) != 0 ||
+        line_width != width || line_height != height || line_radius != radius)
+      continue;
+
+    const BackendInfo *backend = Backends::Find(rule, line_backend);
+    if (backend && (gpu || !backend->gpu_) && backend->available_(width, height, radius))
+      choice = backend;
+  }
+
+  return choice;
+}
+
+static void StoreChoice(const BackendInfo &backend, u32 width, u32 height, f32 radius, boolean gpu, f64 mcs)
+{
+  std::ofstream file(BACKEND_CACHE_FILE, std::ios::app);
+  if (!file)
+  {
+    fprintf(stderr, "Error writing %s\n", BACKEND_CACHE_FILE);
+    return;
+  }
+
+  byte line[256];
+  snprintf(line, sizeof(line), "%s %s %u %u %.9g %s %.1f\n", MachineKey(gpu).c_str(), Backends::RuleName(backend.rule_),
+           width, height, static_cast<f64>(radius), backend.name_, mcs);
+  file << line;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+// Microseconds per generation, the run stops early once it's slower than limit
+// Negative when its programs didn't build
+static f64 Measure(const BackendInfo &backend, u32 width, u32 height, const RuleParams &params, f64 limit)
+{
+  std::unique_ptr<Automata> engine = Backends::Create(backend, width, height, params);
+  if (!engine->ready())
+    return -1.0;
+
+  engine->update();
+  if (backend.gpu_)
+    glFinish();
+
+  TimeCont timer;
+  timer.startTime();
+
+  u32 steps = 0;
+  f64 elapsed = 0.0;
+  while (steps < CALIBRATION_STEPS && elapsed < CALIBRATION_MCS)
+  {
+    engine->update();
+    if (backend.gpu_)
+      glFinish();
+    steps++;
+
+    timer.stopTime();
+    elapsed = static_cast<f64>(timer.getElapsedTime(TimeCont::Precision::microseconds));
+    if (elapsed / steps > limit)
+      break;
+  }
+
+  return elapsed / steps;
+}
+
+std::vector<const BackendInfo *> Backends::List(Rule rule, u32 width, u32 height, f32 radius, boolean gpu)
+{
+  std::vector<const BackendInfo *> list;
+  for (const BackendInfo &backend : backends)
+    if (backend.rule_ == rule && (gpu || !backend.gpu_) && backend.available_(width, height, radius))
+      list.push_back(&backend);
+
+  return list;
+}
+
+const BackendInfo *Backends::Find(Rule rule, const byte *name)
+{
+  for (const BackendInfo &backend : backends)
+    if (backend.rule_ == rule && strcmp(backend.name_, name) == 0)
+      return &backend;
+
+  return nullptr;
+}
+
+const BackendInfo *Backends::Select(Rule rule, u32 width, u32 height, const RuleParams &params, boolean gpu)
+{
+  f32 radius = Radius(rule, params);
+  const BackendInfo *choice = LoadChoice(rule, width, height, radius, gpu);
+  if (choice)
+    return choice;
+
+  return Calibrate(rule, width, height, params, gpu);
+}
+
+const BackendInfo *Backends::Calibrate(Rule rule, u32 width, u32 height, const RuleParams &params, boolean gpu)
+{
+  f32 radius = Radius(rule, params);
+  std::vector<const BackendInfo *> list = List(rule, width, height, radius, gpu);
+  if (list.empty())
+    return nullptr;
+
+  const BackendInfo *fastest = nullptr;
+  f64 best = std::numeric_limits<f64>::max();
+  for (const BackendInfo *backend : list)
+  {
+    f64 mcs = Measure(*backend, width, height, params, best);
+    if (mcs < 0.0)
+    {
+      fprintf(stdout, "Calibration %s %s: programs didn't build\n", RuleName(rule), backend->name_);
+      continue;
+    }
+
+    fprintf(stdout, "Calibration %s %s: %.1f mcs per generation\n", RuleName(rule), backend->name_, mcs);
+
+    if (mcs < best)
+    {
+      best = mcs;
+      fastest = backend;
+    }
+  }
+
+  if (!fastest)
+    return nullptr;
+
+  StoreChoice(*fastest, width, height, radius, gpu, best);
+  return fastest;
+}
+
+std::unique_ptr<Automata> Backends::Create(const BackendInfo &backend, u32 width, u32 height, const RuleParams &params)
+{
+  return backend.create_(Math::Vec2(static_cast<f32>(width), static_cast<f32>(height)), params);
+}
+
+f32 Backends::Radius(Rule rule, const RuleParams &params)
+{
+  if (rule == Rule::Conway || params.radius_ <= 0.0f)
+    return rule_radius[static_cast<s32>(rule)];
+
+  return params.radius_;
+}
+
+const byte *Backends::RuleName(Rule rule)
+{
+  return rule_names[static_cast<s32>(rule)];
+}
+
+boolean Backends::ParseRule(const byte *name, Rule &rule)
+{
+  for (s32 i = 0; i < 3; i++)
+  {
+    if (strcmp(name, rule_names[i]) == 0)
+    {
+      rule = static_cast<Rule>(i);
+      return true;
+    }
+  }
+
+  return false;
+}
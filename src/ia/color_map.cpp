@@ -0,0 +1,72 @@
+#include "ia/color_map.h"
+#include "ia/gpu_helper.h"
+#include "ia/program_batch.h"
+#include "ia/defines.h"
+
+ColorMap::ColorMap()
+{
+  width_ = 0;
+  height_ = 0;
+  program_ = 0;
+  display_id_ = 0;
+}
+
+void ColorMap::init(u32 width, u32 height, u32 channels)
+{
+  width_ = width;
+  height_ = height;
+
+  // A new size or channel count replaces the old texture and program
+  if (program_ != 0)
+    glDeleteProgram(program_);
+  if (display_id_ != 0)
+    glDeleteTextures(1, &display_id_);
+  program_ = 0;
+
+  display_id_ = GPUHelper::CreateTexture(width_, height_, nullptr);
+
+  // Color map shader
+  /////////////////////////////////////////////////////////////////////////////
+  ProgramBatch batch;
+  std::string channels_define = "#define COLOR_MAP_CHANNELS " + std::to_string(channels) + "\n";
+  std::string color_map_string = defines + GPUHelper::GridDefines(width_, height_) + channels_define + LoadSourceFromFile(SHADER("ia/render/color_map_cs.glsl"));
+  batch.add(&program_, color_map_string, "color map program");
+  if (!batch.finish())
+    fprintf(stderr, "Color map program didn't build, the display stays empty\n");
+  /////////////////////////////////////////////////////////////////////////////
+}
+
+ColorMap::~ColorMap()
+{
+  if (program_ != 0)
+    glDeleteProgram(program_);
+  if (display_id_ != 0)
+    glDeleteTextures(1, &display_id_);
+}
+
+u64 ColorMap::memoryUsage() const
+{
+  return (display_id_ != 0) ? static_cast<u64>(width_) * height_ * 4 : 0;
+}
+
+u32 ColorMap::apply(u32 state_texture)
+{
+  if (program_ == 0)
+    return display_id_;
+
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+  glUseProgram(program_);
+
+  glActiveTexture(GL_TEXTURE0 + STATE_SAMPLER_BIND);
+  glBindTexture(GL_TEXTURE_2D, state_texture);
+  glBindImageTexture(DISPLAY_IMG_BIND, display_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+  glDispatchCompute(DISPATCH_GROUPS(width_, X_THREADS), DISPATCH_GROUPS(height_, Y_THREADS), 1);
+  glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glUseProgram(0);
+
+  return display_id_;
+}
@@ -1,8 +1,19 @@
 #include "ia/conway.h"
 #include "ia/gpu_helper.h"
+#include "ia/program_batch.h"
 #include "ia/defines.h"
 
-Conway::Conway() {}
+Conway::Conway()
+{
+  loops_ = 0;
+  compute_program_ = 0;
+  width_ = 0;
+  height_ = 0;
+  prev_data_id_ = 0;
+  current_data_id_ = 0;
+
+  automata_section_ = profiler_.addSection("Automata");
+}
 
 void Conway::init(Math::Vec2 win)
 {
@@ -10,29 +21,30 @@ void Conway::init(Math::Vec2 win)
   width_ = static_cast<u32>(win.x);
   height_ = static_cast<u32>(win.y);
 
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
-
-  if (!data)
-  {
-    width_ = 0;
-    height_ = 0;
-
-    return;
-  }
-
-  current_data_id_ = GPUHelper::CreateTexture(width_, height_, data);
-  prev_data_id_ = GPUHelper::CreateTexture(width_, height_, data);
+  current_data_id_ = GPUHelper::CreateStateTexture(width_, height_, BINARY_STATE_FORMAT);
+  prev_data_id_ = GPUHelper::CreateStateTexture(width_, height_, BINARY_STATE_FORMAT);
 
-  DESTROY(data);
+  color_map_.init(width_, height_);
 
-  compileShaders();
+  // Without its programs the engine doesn't step, F5 builds them again
+  if (!compileShaders() && !ready())
+    fprintf(stderr, "Conway can't step, its programs didn't build\n");
 
   glUseProgram(compute_program_);
 
   reset();
 }
 
-Conway::~Conway() {}
+Conway::~Conway()
+{
+  if (compute_program_ != 0)
+    glDeleteProgram(compute_program_);
+
+  if (prev_data_id_ != 0)
+    glDeleteTextures(1, &prev_data_id_);
+  if (current_data_id_ != 0)
+    glDeleteTextures(1, &current_data_id_);
+}
 
 void Conway::swap()
 {
@@ -41,6 +53,9 @@ void Conway::swap()
 
 void Conway::update()
 {
+  if (!ready())
+    return;
+
   update_timer_.startTime();
   loops_++;
   
@@ -52,21 +67,23 @@ void Conway::update()
   /////////////////////////////////////////////////////////////////////////////
   glUseProgram(compute_program_);
 
-  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
-  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, BINARY_STATE_FORMAT);
+  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, BINARY_STATE_FORMAT);
 
   // Dispatch Compute Shader with appropriate workgroup sizes
-  glDispatchCompute(width_ / X_THREADS, height_ / Y_THREADS, 1);
+  profiler_.begin(automata_section_);
+  glDispatchCompute(DISPATCH_GROUPS(width_, X_THREADS), DISPATCH_GROUPS(height_, Y_THREADS), 1);
+  profiler_.end();
   error = glGetError();
   if (error != GL_NO_ERROR)
     fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
 
-  glMemoryBarrier(GL_ALL_BARRIER_BITS);
+  glMemoryBarrier(STEP_BARRIER_BITS);
 
   glUseProgram(0);
   /////////////////////////////////////////////////////////////////////////////
 
-  glFinish();
+  profiler_.frame();
   update_timer_.stopTime();
 }
 
@@ -75,8 +92,12 @@ void Conway::imgui()
   ImGui::Begin("GPU Automata");
 
   ImGui::Text("Type - Conway");
-  ImGui::Text("Update time: %ld mcs", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
+  ImGui::Text("CPU time: %ld mcs", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
   ImGui::Text("Generation: %d", loops_);
+  profiler_.imgui();
+
+  if (Seeder::Imgui(seed_))
+    reset();
 
   ImGui::End();
 }
@@ -84,61 +105,51 @@ void Conway::imgui()
 void Conway::reset()
 {
   loops_ = 0;
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
+  // One byte per cell like the R8 state, a quarter of the float staging
+  u_byte *data = reinterpret_cast<u_byte *>(staging_.map(static_cast<size_t>(width_) * height_));
 
   if (!data)
     return;
 
-  u_byte alive = 255;
-  u_byte dead = 0;
-
-  for (u32 i = 0; i < width_ * height_ * 4; i += 4)
-  {
-    data[i + 0] = alive;
-    data[i + 1] = alive;
-    data[i + 2] = alive;
+  Seeder::FillBytes(seed_, width_, height_, data);
 
-    data[i + 3] = (rand() % 5 < 2) ? alive : dead;
-  }
-
-  glBindTexture(GL_TEXTURE_2D, current_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-  glBindTexture(GL_TEXTURE_2D, prev_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-
-  DESTROY(data);
+  staging_.upload(current_data_id_, width_, height_, GL_UNSIGNED_BYTE);
+  GPUHelper::CopyState(current_data_id_, prev_data_id_, width_, height_);
 }
 
 void Conway::clean()
 {
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
-
-  if (!data)
-    return;
-
-  glBindTexture(GL_TEXTURE_2D, current_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+  GPUHelper::ClearState(current_data_id_);
+  GPUHelper::ClearState(prev_data_id_);
+}
 
-  glBindTexture(GL_TEXTURE_2D, prev_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+u32 Conway::currentTexture() { return color_map_.apply(current_data_id_); }
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+u64 Conway::memoryUsage() const
+{
+  u64 cells = static_cast<u64>(width_) * height_;
+  return cells * 2 + staging_.size() + color_map_.memoryUsage();
+}
 
-  DESTROY(data);
+void Conway::setCells(const f32 *cells)
+{
+  GPUHelper::UploadState(current_data_id_, width_, height_, GL_FLOAT, cells);
+  GPUHelper::UploadState(prev_data_id_, width_, height_, GL_FLOAT, cells);
 }
 
-u32 Conway::currentTexture() { return current_data_id_; }
+void Conway::getCells(f32 *cells) { GPUHelper::DownloadState(current_data_id_, GL_FLOAT, cells); }
 
-void Conway::compileShaders()
+boolean Conway::ready() const { return compute_program_ != 0; }
+
+boolean Conway::compileShaders()
 {
+  ProgramBatch batch;
+
   // Compute shader
   /////////////////////////////////////////////////////////////////////////////
-  std::string conway_string = defines + LoadSourceFromFile(SHADER("ia/conway/conway_cs.glsl"));
-  const char *conway_cs = conway_string.c_str();
-  GLuint compute_shader = GPUHelper::CompileShader(GL_COMPUTE_SHADER, conway_cs, "conway shader");
-  compute_program_ = GPUHelper::CreateProgram(compute_shader, "conway program");
+  std::string conway_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/conway/conway_cs.glsl"));
+  batch.add(&compute_program_, conway_string, "conway program");
   /////////////////////////////////////////////////////////////////////////////
+
+  return batch.finish();
 }
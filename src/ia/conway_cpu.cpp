@@ -0,0 +1,304 @@
+#include "ia/conway_cpu.h"
+#include "ia/gpu_helper.h"
+#include "ia/parallel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CONWAY_CPU_AVX2 1
+#define FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define FORCE_INLINE inline
+#endif
+
+// Bit sliced adders
+///////////////////////////////////////////////////////////////////////////////
+FORCE_INLINE static void FullAdd(u64 a, u64 b, u64 c, u64 &sum, u64 &carry)
+{
+  u64 half = a ^ b;
+  sum = half ^ c;
+  carry = (a & b) | (half & c);
+}
+
+// Every bit of the words is one cell, the count is kept mod 8 (8 neighbours dies anyway)
+FORCE_INLINE static u64 NextWord(u64 nw, u64 n, u64 ne,
+                                 u64 w, u64 c, u64 e,
+                                 u64 sw, u64 s, u64 se)
+{
+  u64 top_0, top_1;
+  FullAdd(nw, n, ne, top_0, top_1);
+
+  u64 mid_0 = w ^ e;
+  u64 mid_1 = w & e;
+
+  u64 bot_0, bot_1;
+  FullAdd(sw, s, se, bot_0, bot_1);
+
+  u64 ones, carry_2;
+  FullAdd(top_0, mid_0, bot_0, ones, carry_2);
+
+  u64 twos_partial, fours_partial;
+  FullAdd(top_1, mid_1, bot_1, twos_partial, fours_partial);
+
+  u64 twos = twos_partial ^ carry_2;
+  u64 fours = fours_partial ^ (twos_partial & carry_2);
+
+  // Born with 3, survives with 2 or 3
+  return twos & ~fours & (ones | c);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+// Row helpers, bit j of word i is the cell x = i * 64 + j
+///////////////////////////////////////////////////////////////////////////////
+FORCE_INLINE static u64 WestWord(const u64 *row, u32 i, u32 width)
+{
+  u64 carry = (i > 0) ? (row[i - 1] >> 63) : ((row[(width - 1) >> 6] >> ((width - 1) & 63)) & 1);
+  return (row[i] << 1) | carry;
+}
+
+FORCE_INLINE static u64 EastWord(const u64 *row, u32 i, u32 words, u32 width)
+{
+  if (i + 1 < words)
+    return (row[i] >> 1) | (row[i + 1] << 63);
+
+  // Last word, the cell after width - 1 is the first of the row
+  return (row[i] >> 1) | ((row[0] & 1) << ((width - 1) & 63));
+}
+
+FORCE_INLINE static u64 EdgeWord(const u64 *up, const u64 *mid, const u64 *down,
+                                 u32 i, u32 words, u32 width)
+{
+  return NextWord(WestWord(up, i, width), up[i], EastWord(up, i, words, width),
+                  WestWord(mid, i, width), mid[i], EastWord(mid, i, words, width),
+                  WestWord(down, i, width), down[i], EastWord(down, i, words, width));
+}
+
+FORCE_INLINE static void StepRowsImpl(const u64 *prev, u64 *current,
+                                      u32 width, u32 height, u32 words, u64 last_mask,
+                                      u32 first_row, u32 last_row)
+{
+  for (u32 y = first_row; y < last_row; y++)
+  {
+    const u64 *up = prev + static_cast<size_t>((y + height - 1) % height) * words;
+    const u64 *mid = prev + static_cast<size_t>(y) * words;
+    const u64 *down = prev + static_cast<size_t>((y + 1) % height) * words;
+    u64 *out = current + static_cast<size_t>(y) * words;
+
+    // Inner words never wrap so this loop can be vectorized
+    for (u32 i = 1; i + 1 < words; i++)
+    {
+      out[i] = NextWord((up[i] << 1) | (up[i - 1] >> 63), up[i], (up[i] >> 1) | (up[i + 1] << 63),
+                        (mid[i] << 1) | (mid[i - 1] >> 63), mid[i], (mid[i] >> 1) | (mid[i + 1] << 63),
+                        (down[i] << 1) | (down[i - 1] >> 63), down[i], (down[i] >> 1) | (down[i + 1] << 63));
+    }
+
+    out[0] = EdgeWord(up, mid, down, 0, words, width);
+    if (words > 1)
+      out[words - 1] = EdgeWord(up, mid, down, words - 1, words, width);
+
+    // Bits after the width must stay dead for the wrapping
+    out[words - 1] &= last_mask;
+  }
+}
+
+static void StepRowsScalar(const u64 *prev, u64 *current,
+                           u32 width, u32 height, u32 words, u64 last_mask,
+                           u32 first_row, u32 last_row)
+{
+  StepRowsImpl(prev, current, width, height, words, last_mask, first_row, last_row);
+}
+
+#if defined(CONWAY_CPU_AVX2)
+__attribute__((target("avx2"))) static void StepRowsAVX2(const u64 *prev, u64 *current,
+                                                         u32 width, u32 height, u32 words, u64 last_mask,
+                                                         u32 first_row, u32 last_row)
+{
+  StepRowsImpl(prev, current, width, height, words, last_mask, first_row, last_row);
+}
+#endif
+///////////////////////////////////////////////////////////////////////////////
+
+ConwayCPU::ConwayCPU()
+{
+  loops_ = 0;
+  width_ = 0;
+  height_ = 0;
+  words_per_row_ = 0;
+  last_word_mask_ = 0;
+  bands_ = 1;
+  avx2_ = false;
+  texture_dirty_ = false;
+  texture_id_ = 0;
+}
+
+void ConwayCPU::init(Math::Vec2 win)
+{
+  loops_ = 0;
+  width_ = static_cast<u32>(win.x);
+  height_ = static_cast<u32>(win.y);
+
+  if (width_ == 0 || height_ == 0)
+  {
+    width_ = 0;
+    height_ = 0;
+
+    return;
+  }
+
+  words_per_row_ = (width_ + 63) / 64;
+  last_word_mask_ = (width_ & 63) ? ((1ull << (width_ & 63)) - 1) : ~0ull;
+
+  prev_cells_.assign(static_cast<size_t>(words_per_row_) * height_, 0);
+  current_cells_.assign(static_cast<size_t>(words_per_row_) * height_, 0);
+
+#if defined(CONWAY_CPU_AVX2)
+  avx2_ = __builtin_cpu_supports("avx2");
+#endif
+
+  bands_ = std::min(ParallelBands(), height_);
+
+  reset();
+}
+
+ConwayCPU::~ConwayCPU()
+{
+  if (texture_id_ != 0)
+    glDeleteTextures(1, &texture_id_);
+}
+
+void ConwayCPU::swap()
+{
+  std::swap(current_cells_, prev_cells_);
+}
+
+void ConwayCPU::stepRows(u32 first_row, u32 last_row)
+{
+#if defined(CONWAY_CPU_AVX2)
+  if (avx2_)
+  {
+    StepRowsAVX2(prev_cells_.data(), current_cells_.data(), width_, height_, words_per_row_, last_word_mask_, first_row, last_row);
+    return;
+  }
+#endif
+  StepRowsScalar(prev_cells_.data(), current_cells_.data(), width_, height_, words_per_row_, last_word_mask_, first_row, last_row);
+}
+
+void ConwayCPU::update()
+{
+  update_timer_.startTime();
+  loops_++;
+
+  swap();
+
+  // CPU Automata
+  /////////////////////////////////////////////////////////////////////////////
+  ParallelFor(height_, [this](u32 first_row, u32 last_row)
+              { stepRows(first_row, last_row); });
+  /////////////////////////////////////////////////////////////////////////////
+
+  texture_dirty_ = true;
+  update_timer_.stopTime();
+}
+
+void ConwayCPU::imgui()
+{
+  size_t elapsed = update_timer_.getElapsedTime(TimeCont::Precision::microseconds);
+  f64 cells_per_second = (elapsed > 0) ? static_cast<f64>(width_) * static_cast<f64>(height_) / (static_cast<f64>(elapsed) / 1e6) : 0.0;
+
+  ImGui::Begin("GPU Automata");
+
+  ImGui::Text("Type - Conway (CPU)");
+  ImGui::Text("Update time: %ld mcs", elapsed);
+  ImGui::Text("Generation: %d", loops_);
+  ImGui::Text("Cell updates: %.2f G/s", cells_per_second / 1e9);
+  ImGui::Text("Threads: %d - %s", bands_, avx2_ ? "AVX2" : "Scalar");
+
+  if (Seeder::Imgui(seed_))
+    reset();
+
+  ImGui::End();
+}
+
+void ConwayCPU::reset()
+{
+  loops_ = 0;
+
+  std::vector<f32> cells(static_cast<size_t>(width_) * height_);
+  Seeder::Fill(seed_, width_, height_, true, cells.data());
+
+  std::fill(current_cells_.begin(), current_cells_.end(), 0);
+  for (u32 y = 0; y < height_; y++)
+    for (u32 x = 0; x < width_; x++)
+      if (cells[static_cast<size_t>(y) * width_ + x] > 0.5f)
+        current_cells_[static_cast<size_t>(y) * words_per_row_ + (x >> 6)] |= 1ull << (x & 63);
+
+  prev_cells_ = current_cells_;
+  texture_dirty_ = true;
+}
+
+void ConwayCPU::clean()
+{
+  std::fill(current_cells_.begin(), current_cells_.end(), 0);
+  std::fill(prev_cells_.begin(), prev_cells_.end(), 0);
+  texture_dirty_ = true;
+}
+
+void ConwayCPU::setCells(const u_byte *rgba)
+{
+  clean();
+
+  for (u32 y = 0; y < height_; y++)
+    for (u32 x = 0; x < width_; x++)
+      if (rgba[(static_cast<size_t>(y) * width_ + x) * 4 + 3] > 127)
+        current_cells_[static_cast<size_t>(y) * words_per_row_ + (x >> 6)] |= 1ull << (x & 63);
+
+  prev_cells_ = current_cells_;
+}
+
+void ConwayCPU::getCells(u_byte *rgba) const
+{
+  for (u32 y = 0; y < height_; y++)
+  {
+    for (u32 x = 0; x < width_; x++)
+    {
+      u_byte *pixel = rgba + (static_cast<size_t>(y) * width_ + x) * 4;
+      pixel[0] = 255;
+      pixel[1] = 255;
+      pixel[2] = 255;
+      pixel[3] = cell(x, y) ? 255 : 0;
+    }
+  }
+}
+
+boolean ConwayCPU::cell(u32 x, u32 y) const
+{
+  return (current_cells_[static_cast<size_t>(y) * words_per_row_ + (x >> 6)] >> (x & 63)) & 1;
+}
+
+u32 ConwayCPU::currentTexture()
+{
+  if (texture_id_ == 0)
+  {
+    texture_id_ = GPUHelper::CreateTexture(width_, height_, nullptr);
+    texture_dirty_ = true;
+  }
+
+  if (texture_dirty_)
+  {
+    staging_.resize(static_cast<size_t>(width_) * height_ * 4);
+    getCells(staging_.data());
+
+    glBindTexture(GL_TEXTURE_2D, texture_id_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, staging_.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    texture_dirty_ = false;
+  }
+
+  return texture_id_;
+}
+
+u64 ConwayCPU::memoryUsage() const
+{
+  u64 words = (prev_cells_.capacity() + current_cells_.capacity()) * sizeof(u64);
+  u64 texture = (texture_id_ != 0) ? static_cast<u64>(width_) * height_ * 4 : 0;
+  return words + staging_.capacity() + texture;
+}
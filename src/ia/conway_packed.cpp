@@ -0,0 +1,247 @@
+#include "ia/conway_packed.h"
+#include "ia/gpu_helper.h"
+#include "ia/program_batch.h"
+#include "ia/defines.h"
+
+ConwayPacked::ConwayPacked()
+{
+  loops_ = 0;
+  compute_program_ = 0;
+  unpack_program_ = 0;
+  width_ = 0;
+  height_ = 0;
+  row_words_ = 0;
+  display_scale_ = 1;
+  display_width_ = 0;
+  display_height_ = 0;
+  display_dirty_ = true;
+  prev_cells_ssbo_ = 0;
+  current_cells_ssbo_ = 0;
+  display_data_id_ = 0;
+
+  automata_section_ = profiler_.addSection("Automata");
+  unpack_section_ = profiler_.addSection("Unpack");
+}
+
+void ConwayPacked::init(Math::Vec2 win)
+{
+  loops_ = 0;
+  width_ = static_cast<u32>(win.x);
+  height_ = static_cast<u32>(win.y);
+  row_words_ = DISPATCH_GROUPS(width_, 32);
+
+  display_scale_ = DISPATCH_GROUPS(std::max(width_, height_), PACKED_DISPLAY_SIZE);
+  display_width_ = DISPATCH_GROUPS(width_, display_scale_);
+  display_height_ = DISPATCH_GROUPS(height_, display_scale_);
+
+  // Cells
+  /////////////////////////////////////////////////////////////////////////////
+  GLsizeiptr cells_size = static_cast<GLsizeiptr>(row_words_) * height_ * sizeof(u32);
+
+  glGenBuffers(1, &prev_cells_ssbo_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, prev_cells_ssbo_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, cells_size, nullptr, GL_DYNAMIC_COPY);
+
+  glGenBuffers(1, &current_cells_ssbo_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, current_cells_ssbo_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, cells_size, nullptr, GL_DYNAMIC_COPY);
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  /////////////////////////////////////////////////////////////////////////////
+
+  display_data_id_ = GPUHelper::CreateStateTexture(display_width_, display_height_, BINARY_STATE_FORMAT);
+
+  color_map_.init(display_width_, display_height_);
+
+  // Without its programs the engine doesn't step, F5 builds them again
+  if (!compileShaders() && !ready())
+    fprintf(stderr, "Conway packed can't step, its programs didn't build\n");
+
+  clean();
+  reset();
+}
+
+ConwayPacked::~ConwayPacked()
+{
+  if (compute_program_ != 0)
+    glDeleteProgram(compute_program_);
+  if (unpack_program_ != 0)
+    glDeleteProgram(unpack_program_);
+
+  if (prev_cells_ssbo_ != 0)
+    glDeleteBuffers(1, &prev_cells_ssbo_);
+  if (current_cells_ssbo_ != 0)
+    glDeleteBuffers(1, &current_cells_ssbo_);
+
+  if (display_data_id_ != 0)
+    glDeleteTextures(1, &display_data_id_);
+}
+
+void ConwayPacked::swap()
+{
+  std::swap(current_cells_ssbo_, prev_cells_ssbo_);
+}
+
+void ConwayPacked::update()
+{
+  if (!ready())
+    return;
+
+  update_timer_.startTime();
+  loops_++;
+
+  swap();
+
+  GLenum error = GL_NO_ERROR;
+
+  // GPU Automata
+  /////////////////////////////////////////////////////////////////////////////
+  glUseProgram(compute_program_);
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PACKED_PREV_BIND, prev_cells_ssbo_);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PACKED_CURR_BIND, current_cells_ssbo_);
+
+  profiler_.begin(automata_section_);
+  glDispatchCompute(DISPATCH_GROUPS(row_words_, X_THREADS), DISPATCH_GROUPS(height_, Y_THREADS), 1);
+  profiler_.end();
+  error = glGetError();
+  if (error != GL_NO_ERROR)
+    fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
+
+  glMemoryBarrier(STEP_BARRIER_BITS);
+
+  glUseProgram(0);
+  /////////////////////////////////////////////////////////////////////////////
+
+  display_dirty_ = true;
+
+  profiler_.frame();
+  update_timer_.stopTime();
+}
+
+void ConwayPacked::imgui()
+{
+  ImGui::Begin("GPU Automata");
+
+  ImGui::Text("Type - Conway packed");
+  ImGui::Text("CPU time: %ld mcs", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
+  ImGui::Text("Generation: %d", loops_);
+  ImGui::Text("Grid: %ux%u - Display 1:%u", width_, height_, display_scale_);
+  profiler_.imgui();
+
+  if (Seeder::Imgui(seed_))
+    reset();
+
+  ImGui::End();
+}
+
+void ConwayPacked::reset()
+{
+  loops_ = 0;
+  size_t cells_size = static_cast<size_t>(row_words_) * height_ * sizeof(u32);
+  u32 *words = reinterpret_cast<u32 *>(staging_.map(cells_size));
+
+  if (!words)
+    return;
+
+  Seeder::FillBits(seed_, width_, height_, words);
+
+  staging_.copy(current_cells_ssbo_, cells_size);
+  display_dirty_ = true;
+}
+
+void ConwayPacked::clean()
+{
+  for (u32 ssbo : {prev_cells_ssbo_, current_cells_ssbo_})
+  {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  display_dirty_ = true;
+}
+
+u32 ConwayPacked::currentTexture()
+{
+  if (display_dirty_ && ready())
+  {
+    glUseProgram(unpack_program_);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PACKED_CURR_BIND, current_cells_ssbo_);
+    glBindImageTexture(CURR_IMG_BIND, display_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, BINARY_STATE_FORMAT);
+
+    profiler_.begin(unpack_section_);
+    glDispatchCompute(DISPATCH_GROUPS(display_width_, X_THREADS), DISPATCH_GROUPS(display_height_, Y_THREADS), 1);
+    profiler_.end();
+
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    glUseProgram(0);
+
+    display_dirty_ = false;
+  }
+
+  return color_map_.apply(display_data_id_);
+}
+
+u64 ConwayPacked::memoryUsage() const
+{
+  u64 words = static_cast<u64>(row_words_) * height_;
+  u64 display = static_cast<u64>(display_width_) * display_height_;
+  return words * sizeof(u32) * 2 + display + staging_.size() + words_.capacity() * sizeof(u32) + color_map_.memoryUsage();
+}
+
+void ConwayPacked::setCells(const f32 *cells)
+{
+  words_.assign(static_cast<size_t>(row_words_) * height_, 0u);
+  for (u32 y = 0; y < height_; y++)
+    for (u32 x = 0; x < width_; x++)
+      if (cells[static_cast<size_t>(y) * width_ + x] > 0.5f)
+        words_[static_cast<size_t>(y) * row_words_ + x / 32] |= 1u << (x % 32);
+
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, current_cells_ssbo_);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(words_.size() * sizeof(u32)), words_.data());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  display_dirty_ = true;
+}
+
+void ConwayPacked::getCells(f32 *cells)
+{
+  words_.resize(static_cast<size_t>(row_words_) * height_);
+
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, current_cells_ssbo_);
+  glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(words_.size() * sizeof(u32)), words_.data());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  for (u32 y = 0; y < height_; y++)
+    for (u32 x = 0; x < width_; x++)
+      cells[static_cast<size_t>(y) * width_ + x] = static_cast<f32>((words_[static_cast<size_t>(y) * row_words_ + x / 32] >> (x % 32)) & 1u);
+}
+
+boolean ConwayPacked::ready() const { return compute_program_ != 0 && unpack_program_ != 0; }
+
+boolean ConwayPacked::compileShaders()
+{
+  ProgramBatch batch;
+  std::string grid = defines + GPUHelper::GridDefines(width_, height_);
+
+  // Compute shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string packed_string = grid + LoadSourceFromFile(SHADER("ia/conway/packed_cs.glsl"));
+  batch.add(&compute_program_, packed_string, "conway packed program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  // Unpack shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string display = "#define DISPLAY_SCALE " + std::to_string(display_scale_) + "\n" +
+                        "#define D_WIDTH " + std::to_string(display_width_) + "\n" +
+                        "#define D_HEIGHT " + std::to_string(display_height_) + "\n";
+  std::string unpack_string = grid + display + LoadSourceFromFile(SHADER("ia/conway/unpack_cs.glsl"));
+  batch.add(&unpack_program_, unpack_string, "conway unpack program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  return batch.finish();
+}
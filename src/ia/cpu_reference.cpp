@@ -0,0 +1,402 @@
+#include "ia/cpu_reference.h"
+#include "ia/gpu_helper.h"
+#include "ia/parallel.h"
+#include "ia/defines.h"
+
+// Same results than the WRAP of the shaders for any offset
+static inline s32 Wrap(s32 value, s32 size)
+{
+  return (value >= 0) ? (value % size) : (size - 1 - ((-value - 1) % size));
+}
+
+// Whole grid sizes before the coord, negative out of the grid
+static inline s32 Laps(s32 value, s32 size)
+{
+  return (value >= 0) ? (value / size) : -((size - 1 - value) / size);
+}
+
+// What a R16F texel keeps of the value, nearest (ties to even) or toward zero
+static f32 RoundToHalf(f32 value, boolean nearest)
+{
+  // Subnormal halves are multiples of 2^-24
+  if (std::fabs(value) < 6.103515625e-05f)
+  {
+    f32 scaled = value * 16777216.0f;
+    return (nearest ? std::nearbyint(scaled) : std::trunc(scaled)) / 16777216.0f;
+  }
+
+  u32 bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  if (nearest)
+    bits += 0x0FFFu + ((bits >> 13) & 1u);
+  bits &= ~0x1FFFu;
+  std::memcpy(&value, &bits, sizeof(bits));
+
+  return value;
+}
+
+CPUReference::CPUReference(ReferenceType type)
+{
+  type_ = type;
+  loops_ = 0;
+  width_ = 0;
+  height_ = 0;
+  precision_ = ReferencePrecision::HalfNearest;
+  texture_dirty_ = false;
+  texture_id_ = 0;
+
+  // Same defaults than the GPU engines
+  radius_ = (type_ == ReferenceType::SmoothLife) ? O_RADIUS : 15.0f;
+  dt_ = 5.0f;
+  mu_ = 0.14f;
+  sigma_ = 0.014f;
+  rho_ = 0.5f;
+  omega_ = 0.15f;
+}
+
+void CPUReference::init(Math::Vec2 win)
+{
+  loops_ = 0;
+  width_ = static_cast<u32>(win.x);
+  height_ = static_cast<u32>(win.y);
+
+  prev_cells_.assign(static_cast<size_t>(width_) * height_, 0.0f);
+  current_cells_.assign(static_cast<size_t>(width_) * height_, 0.0f);
+  if (type_ == ReferenceType::SmoothLife)
+    row_prefix_.assign(static_cast<size_t>(width_) * height_, 0.0f);
+
+  reset();
+}
+
+CPUReference::~CPUReference()
+{
+  if (texture_id_ != 0)
+    glDeleteTextures(1, &texture_id_);
+}
+
+void CPUReference::swap()
+{
+  std::swap(current_cells_, prev_cells_);
+}
+
+f32 CPUReference::store(f32 value) const
+{
+  if (precision_ == ReferencePrecision::Float)
+    return value;
+
+  return RoundToHalf(value, precision_ == ReferencePrecision::HalfNearest);
+}
+
+f32 CPUReference::growth(f32 value, f32 avg) const
+{
+  f32 bell = (GaussBell(avg, mu_, sigma_) * 2.0f) - 1.0f;
+
+  return store(std::clamp(value + (1.0f / dt_) * bell, 0.0f, 1.0f));
+}
+
+void CPUReference::update()
+{
+  update_timer_.startTime();
+  loops_++;
+
+  swap();
+
+  // CPU Automata
+  /////////////////////////////////////////////////////////////////////////////
+  switch (type_)
+  {
+  case ReferenceType::Conway:
+    ParallelFor(height_, [this](u32 first_row, u32 last_row)
+                { stepConway(first_row, last_row); });
+    break;
+
+  case ReferenceType::SmoothLife:
+    // Row prefix sums first, the spans of a cell read other rows
+    ParallelFor(height_, [this](u32 first_row, u32 last_row)
+                {
+                  for (u32 y = first_row; y < last_row; y++)
+                  {
+                    f32 sum = 0.0f;
+                    for (u32 x = 0; x < width_; x++)
+                    {
+                      sum += prev_cells_[ARRAY_2D_INDEX(x, y, width_)];
+                      row_prefix_[ARRAY_2D_INDEX(x, y, width_)] = sum;
+                    }
+                  } });
+    ParallelFor(height_, [this](u32 first_row, u32 last_row)
+                { stepSmoothLife(first_row, last_row); });
+    break;
+
+  case ReferenceType::Lenia:
+    kernel_.update(radius_, rho_, omega_);
+    ParallelFor(height_, [this](u32 first_row, u32 last_row)
+                { stepLenia(first_row, last_row); });
+    break;
+
+  case ReferenceType::LeniaOp:
+    kernel_.update(static_cast<f32>(static_cast<s32>(radius_)), rho_, omega_);
+    ParallelFor(height_, [this](u32 first_row, u32 last_row)
+                { stepLeniaOp(first_row, last_row); });
+    break;
+  }
+  /////////////////////////////////////////////////////////////////////////////
+
+  texture_dirty_ = true;
+  update_timer_.stopTime();
+}
+
+// conway_cs, the neighbours are added as floats and the cell subtracted after
+void CPUReference::stepConway(u32 first_row, u32 last_row)
+{
+  s32 width = static_cast<s32>(width_);
+  s32 height = static_cast<s32>(height_);
+
+  for (s32 y = static_cast<s32>(first_row); y < static_cast<s32>(last_row); y++)
+  {
+    for (s32 x = 0; x < width; x++)
+    {
+      f32 alpha = prev_cells_[ARRAY_2D_INDEX(x, y, width_)];
+
+      f32 alive_neighbors = 0.0f;
+      for (s32 i = -1; i <= 1; i++)
+        for (s32 j = -1; j <= 1; j++)
+          alive_neighbors += prev_cells_[ARRAY_2D_INDEX(Wrap(x + i, width), Wrap(y + j, height), width_)];
+      alive_neighbors -= alpha;
+
+      if (alpha > 0.5f)
+      {
+        if (alive_neighbors < 2.0f || alive_neighbors > 3.0f)
+          alpha = 0.0f;
+      }
+      else if (alive_neighbors == 3.0f)
+      {
+        alpha = 1.0f;
+      }
+
+      current_cells_[ARRAY_2D_INDEX(x, y, width_)] = alpha;
+    }
+  }
+}
+
+// Cells in (start_x, end_x] of the row, any offset wraps
+f32 CPUReference::rowSpan(s32 start_x, s32 end_x, s32 row) const
+{
+  s32 width = static_cast<s32>(width_);
+  s32 wrapped_row = Wrap(row, static_cast<s32>(height_));
+  f32 lap = row_prefix_[ARRAY_2D_INDEX(width - 1, wrapped_row, width_)];
+
+  s32 start_laps = Laps(start_x, width);
+  s32 end_laps = Laps(end_x, width);
+  f32 start = static_cast<f32>(start_laps) * lap + row_prefix_[ARRAY_2D_INDEX(start_x - start_laps * width, wrapped_row, width_)];
+  f32 end = static_cast<f32>(end_laps) * lap + row_prefix_[ARRAY_2D_INDEX(end_x - end_laps * width, wrapped_row, width_)];
+
+  return end - start;
+}
+
+// smooth_cs with the row spans, near spans (col - 1, col + 1] of 3 rows and the disk rows of floor(sqrt(r^2 - y^2))
+void CPUReference::stepSmoothLife(u32 first_row, u32 last_row)
+{
+  s32 radius = static_cast<s32>(radius_);
+
+  for (s32 row = static_cast<s32>(first_row); row < static_cast<s32>(last_row); row++)
+  {
+    for (s32 col = 0; col < static_cast<s32>(width_); col++)
+    {
+      f32 near_live = 0.0f;
+      for (s32 y = -1; y <= 1; y++)
+        near_live += rowSpan(col - 1, col + 1, row + y);
+      f32 near_count = 6.0f;
+
+      f32 far_live = 0.0f, far_count = 0.0f;
+      for (s32 y = -radius; y <= radius; y++)
+      {
+        s32 x_offset = static_cast<s32>(std::floor(std::sqrt(radius_ * radius_ - static_cast<f32>(y * y))));
+        far_live += rowSpan(col - x_offset - 1, col + x_offset, row + y);
+        far_count += static_cast<f32>(x_offset * 2 + 1);
+      }
+      far_live -= near_live;
+      far_count -= near_count;
+
+      f32 far_div = far_live / far_count;
+      f32 near_div = near_live / near_count;
+
+      f32 alpha = 0.0f;
+      if (near_div >= 0.5f && 0.26f <= far_div && far_div <= 0.46f)
+        alpha = 1.0f;
+      if (near_div < 0.5f && 0.27f <= far_div && far_div <= 0.36f)
+        alpha = 1.0f;
+
+      current_cells_[ARRAY_2D_INDEX(col, row, width_)] = alpha;
+    }
+  }
+}
+
+// lenia_cs, columns outside and rows inside like the shader loops
+void CPUReference::stepLenia(u32 first_row, u32 last_row)
+{
+  s32 width = static_cast<s32>(width_);
+  s32 height = static_cast<s32>(height_);
+  s32 extent = kernel_.extent();
+  s32 side = extent * 2 + 1;
+  const std::vector<f32> &weights = kernel_.weights();
+
+  for (s32 cy = static_cast<s32>(first_row); cy < static_cast<s32>(last_row); cy++)
+  {
+    for (s32 cx = 0; cx < width; cx++)
+    {
+      f32 sum = 0.0f;
+      for (s32 x = -extent; x <= extent; x++)
+      {
+        s32 nx = Wrap(cx + x, width);
+        for (s32 y = -extent; y <= extent; y++)
+          sum += prev_cells_[ARRAY_2D_INDEX(nx, Wrap(cy + y, height), width_)] * weights[ARRAY_2D_INDEX(x + extent, y + extent, side)];
+      }
+
+      current_cells_[ARRAY_2D_INDEX(cx, cy, width_)] = growth(prev_cells_[ARRAY_2D_INDEX(cx, cy, width_)], sum);
+    }
+  }
+}
+
+// LeniaOp counter_cs, each of the COUNTER_LINES partials adds every COUNTER_LINES-th kernel row
+void CPUReference::stepLeniaOp(u32 first_row, u32 last_row)
+{
+  s32 width = static_cast<s32>(width_);
+  s32 height = static_cast<s32>(height_);
+  s32 radius = kernel_.extent();
+  s32 side = radius * 2 + 1;
+  const std::vector<f32> &weights = kernel_.weights();
+
+  for (s32 cy = static_cast<s32>(first_row); cy < static_cast<s32>(last_row); cy++)
+  {
+    for (s32 cx = 0; cx < width; cx++)
+    {
+      f32 sum = 0.0f;
+      for (s32 line = 0; line < COUNTER_LINES; line++)
+      {
+        f32 partial = 0.0f;
+        for (s32 local_y = line - radius; local_y <= radius; local_y += COUNTER_LINES)
+        {
+          s32 ny = Wrap(local_y + cy, height);
+          const f32 *kernel_row = weights.data() + ARRAY_2D_INDEX(0, local_y + radius, side);
+
+          f32 row = 0.0f;
+          for (s32 local_x = -radius; local_x <= radius; local_x++)
+            row += prev_cells_[ARRAY_2D_INDEX(Wrap(local_x + cx, width), ny, width_)] * kernel_row[local_x + radius];
+          partial += row;
+        }
+        sum += partial;
+      }
+
+      current_cells_[ARRAY_2D_INDEX(cx, cy, width_)] = growth(prev_cells_[ARRAY_2D_INDEX(cx, cy, width_)], sum);
+    }
+  }
+}
+
+void CPUReference::imgui()
+{
+  static const char *names[] = {"Conway", "SmoothLife", "Lenia", "LeniaOp"};
+  size_t elapsed = update_timer_.getElapsedTime(TimeCont::Precision::microseconds);
+
+  ImGui::Begin("GPU Automata");
+
+  ImGui::Text("Type - %s (CPU reference)", names[static_cast<s32>(type_)]);
+  ImGui::Text("Update time: %ld mcs", elapsed);
+  ImGui::Text("Generation: %d", loops_);
+  ImGui::Text("Threads: %d", ParallelBands());
+
+  if (type_ == ReferenceType::SmoothLife)
+    ImGui::SliderFloat("Radius", &radius_, 4.0f, 32.0f);
+
+  if (type_ == ReferenceType::Lenia || type_ == ReferenceType::LeniaOp)
+  {
+    static const char *precisions[] = {"Float", "Half nearest", "Half toward zero"};
+    s32 precision = static_cast<s32>(precision_);
+    if (ImGui::Combo("Precision", &precision, precisions, 3))
+      precision_ = static_cast<ReferencePrecision>(precision);
+    ImGui::SliderFloat("Radius", &radius_, 10.0f, 25.0f);
+    ImGui::SliderFloat("Delta Time", &dt_, 5.0f, 15.0f);
+    ImGui::SliderFloat("Mu", &mu_, 0.14f, 0.7f);
+    ImGui::SliderFloat("Sigma", &sigma_, 0.014f, 0.07f);
+    ImGui::SliderFloat("Rho", &rho_, 0.025f, 0.75f);
+    ImGui::SliderFloat("Omega", &omega_, 0.025f, 0.25f);
+  }
+
+  if (Seeder::Imgui(seed_))
+    reset();
+
+  ImGui::End();
+}
+
+void CPUReference::reset()
+{
+  loops_ = 0;
+
+  // Same cells than a GPU engine with the same seed_, before its state format rounding
+  boolean binary = (type_ == ReferenceType::Conway || type_ == ReferenceType::SmoothLife);
+  Seeder::Fill(seed_, width_, height_, binary, current_cells_.data());
+  if (!binary)
+    for (f32 &cell : current_cells_)
+      cell = store(cell);
+
+  prev_cells_ = current_cells_;
+  texture_dirty_ = true;
+}
+
+void CPUReference::clean()
+{
+  std::fill(current_cells_.begin(), current_cells_.end(), 0.0f);
+  std::fill(prev_cells_.begin(), prev_cells_.end(), 0.0f);
+  texture_dirty_ = true;
+}
+
+void CPUReference::setCells(const f32 *cells)
+{
+  for (size_t i = 0; i < current_cells_.size(); i++)
+    current_cells_[i] = store(cells[i]);
+
+  prev_cells_ = current_cells_;
+  texture_dirty_ = true;
+}
+
+const std::vector<f32> &CPUReference::cells() const { return current_cells_; }
+
+ReferenceType CPUReference::type() const { return type_; }
+
+u32 CPUReference::generation() const { return loops_; }
+
+u32 CPUReference::currentTexture()
+{
+  if (texture_id_ == 0)
+  {
+    texture_id_ = GPUHelper::CreateTexture(width_, height_, nullptr);
+    texture_dirty_ = true;
+  }
+
+  if (texture_dirty_)
+  {
+    // Same look than ColorMap, white with the cell as alpha
+    staging_.resize(static_cast<size_t>(width_) * height_ * 4);
+    for (size_t i = 0; i < current_cells_.size(); i++)
+    {
+      staging_[i * 4 + 0] = 255;
+      staging_[i * 4 + 1] = 255;
+      staging_[i * 4 + 2] = 255;
+      staging_[i * 4 + 3] = static_cast<u_byte>(current_cells_[i] * 255.0f + 0.5f);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture_id_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, staging_.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    texture_dirty_ = false;
+  }
+
+  return texture_id_;
+}
+
+u64 CPUReference::memoryUsage() const
+{
+  u64 cells = (prev_cells_.capacity() + current_cells_.capacity() + row_prefix_.capacity()) * sizeof(f32);
+  u64 texture = (texture_id_ != 0) ? static_cast<u64>(width_) * height_ * 4 : 0;
+  return cells + staging_.capacity() + texture;
+}
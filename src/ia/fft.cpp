@@ -0,0 +1,225 @@
+#include "ia/fft.h"
+#include "ia/parallel.h"
+
+#define FFT_COLUMN_BLOCK 16
+#define FFT_PI 3.14159265358979323846
+
+FFT::FFT()
+{
+  size_ = 0;
+  padded_size_ = 0;
+  log2_ = 0;
+}
+
+boolean FFT::IsPowerOfTwo(u32 value)
+{
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+void FFT::init(u32 size)
+{
+  size_ = size;
+
+  // Bluestein needs a power of two able to hold the 2n - 1 chirp convolution
+  padded_size_ = 1;
+  while (padded_size_ < (IsPowerOfTwo(size_) ? size_ : 2 * size_ - 1))
+    padded_size_ <<= 1;
+
+  log2_ = 0;
+  while ((1u << log2_) < padded_size_)
+    log2_++;
+
+  reversed_.resize(padded_size_);
+  for (u32 i = 0; i < padded_size_; i++)
+  {
+    u32 reversed = 0;
+    for (u32 bit = 0; bit < log2_; bit++)
+      reversed |= ((i >> bit) & 1) << (log2_ - 1 - bit);
+    reversed_[i] = reversed;
+  }
+
+  twiddles_.resize(padded_size_ / 2);
+  for (u32 i = 0; i < padded_size_ / 2; i++)
+  {
+    f64 angle = -2.0 * FFT_PI * static_cast<f64>(i) / static_cast<f64>(padded_size_);
+    twiddles_[i] = Complex(static_cast<f32>(cos(angle)), static_cast<f32>(sin(angle)));
+  }
+
+  chirp_.clear();
+  chirp_spectrum_.clear();
+  if (IsPowerOfTwo(size_))
+    return;
+
+  // Chirp exp(-i * pi * k^2 / n), k^2 taken mod 2n to keep the angle precise
+  chirp_.resize(size_);
+  for (u32 k = 0; k < size_; k++)
+  {
+    u64 k_squared = (static_cast<u64>(k) * k) % (2ull * size_);
+    f64 angle = -FFT_PI * static_cast<f64>(k_squared) / static_cast<f64>(size_);
+    chirp_[k] = Complex(static_cast<f32>(cos(angle)), static_cast<f32>(sin(angle)));
+  }
+
+  chirp_spectrum_.assign(padded_size_, Complex(0.0f, 0.0f));
+  chirp_spectrum_[0] = std::conj(chirp_[0]);
+  for (u32 k = 1; k < size_; k++)
+  {
+    chirp_spectrum_[k] = std::conj(chirp_[k]);
+    chirp_spectrum_[padded_size_ - k] = std::conj(chirp_[k]);
+  }
+  radix2(chirp_spectrum_.data(), false);
+}
+
+FFT::~FFT() {}
+
+void FFT::radix2(Complex *data, boolean inverse) const
+{
+  for (u32 i = 0; i < padded_size_; i++)
+    if (i < reversed_[i])
+      std::swap(data[i], data[reversed_[i]]);
+
+  for (u32 length = 2; length <= padded_size_; length <<= 1)
+  {
+    u32 half = length >> 1;
+    u32 step = padded_size_ / length;
+
+    for (u32 start = 0; start < padded_size_; start += length)
+    {
+      for (u32 j = 0; j < half; j++)
+      {
+        Complex twiddle = inverse ? std::conj(twiddles_[j * step]) : twiddles_[j * step];
+        Complex even = data[start + j];
+        Complex odd = data[start + j + half] * twiddle;
+
+        data[start + j] = even + odd;
+        data[start + j + half] = even - odd;
+      }
+    }
+  }
+}
+
+void FFT::bluestein(Complex *data, Complex *scratch) const
+{
+  for (u32 k = 0; k < size_; k++)
+    scratch[k] = data[k] * chirp_[k];
+  for (u32 k = size_; k < padded_size_; k++)
+    scratch[k] = Complex(0.0f, 0.0f);
+
+  radix2(scratch, false);
+  for (u32 k = 0; k < padded_size_; k++)
+    scratch[k] *= chirp_spectrum_[k];
+  radix2(scratch, true);
+
+  f32 scale = 1.0f / static_cast<f32>(padded_size_);
+  for (u32 k = 0; k < size_; k++)
+    data[k] = scratch[k] * chirp_[k] * scale;
+}
+
+void FFT::forward(Complex *data, Complex *scratch) const
+{
+  if (chirp_.empty())
+    radix2(data, false);
+  else
+    bluestein(data, scratch);
+}
+
+void FFT::inverse(Complex *data, Complex *scratch) const
+{
+  if (chirp_.empty())
+  {
+    radix2(data, true);
+    return;
+  }
+
+  // ifft(x) = conj(fft(conj(x)))
+  for (u32 k = 0; k < size_; k++)
+    data[k] = std::conj(data[k]);
+  bluestein(data, scratch);
+  for (u32 k = 0; k < size_; k++)
+    data[k] = std::conj(data[k]);
+}
+
+u32 FFT::size() const { return size_; }
+
+u32 FFT::scratchSize() const { return chirp_.empty() ? 0 : padded_size_; }
+
+// 2D
+///////////////////////////////////////////////////////////////////////////////
+FFT2D::FFT2D()
+{
+  width_ = 0;
+  height_ = 0;
+}
+
+void FFT2D::init(u32 width, u32 height)
+{
+  width_ = width;
+  height_ = height;
+
+  row_fft_.init(width_);
+  column_fft_.init(height_);
+}
+
+FFT2D::~FFT2D() {}
+
+void FFT2D::rows(Complex *data, boolean inverse, u32 first_row, u32 last_row) const
+{
+  std::vector<Complex> scratch(row_fft_.scratchSize());
+
+  for (u32 y = first_row; y < last_row; y++)
+  {
+    Complex *row = data + static_cast<size_t>(y) * width_;
+    if (inverse)
+      row_fft_.inverse(row, scratch.data());
+    else
+      row_fft_.forward(row, scratch.data());
+  }
+}
+
+void FFT2D::columns(Complex *data, boolean inverse, u32 first_column, u32 last_column) const
+{
+  std::vector<Complex> scratch(column_fft_.scratchSize());
+  std::vector<Complex> block(static_cast<size_t>(FFT_COLUMN_BLOCK) * height_);
+
+  // Columns are copied in blocks so every row read stays in the same cache lines
+  for (u32 x = first_column; x < last_column; x += FFT_COLUMN_BLOCK)
+  {
+    u32 count = std::min(static_cast<u32>(FFT_COLUMN_BLOCK), last_column - x);
+
+    for (u32 y = 0; y < height_; y++)
+      for (u32 c = 0; c < count; c++)
+        block[static_cast<size_t>(c) * height_ + y] = data[static_cast<size_t>(y) * width_ + x + c];
+
+    for (u32 c = 0; c < count; c++)
+    {
+      Complex *column = block.data() + static_cast<size_t>(c) * height_;
+      if (inverse)
+        column_fft_.inverse(column, scratch.data());
+      else
+        column_fft_.forward(column, scratch.data());
+    }
+
+    for (u32 y = 0; y < height_; y++)
+      for (u32 c = 0; c < count; c++)
+        data[static_cast<size_t>(y) * width_ + x + c] = block[static_cast<size_t>(c) * height_ + y];
+  }
+}
+
+void FFT2D::transform(Complex *data, boolean inverse) const
+{
+  ParallelFor(height_, [this, data, inverse](u32 first_row, u32 last_row)
+              { rows(data, inverse, first_row, last_row); });
+
+  // Bands of columns aligned to the copy blocks
+  ParallelFor(width_, [this, data, inverse](u32 first_column, u32 last_column)
+              { columns(data, inverse, first_column, last_column); },
+              FFT_COLUMN_BLOCK);
+}
+
+void FFT2D::forward(Complex *data) const { transform(data, false); }
+
+void FFT2D::inverse(Complex *data) const { transform(data, true); }
+
+u32 FFT2D::width() const { return width_; }
+
+u32 FFT2D::height() const { return height_; }
+///////////////////////////////////////////////////////////////////////////////
@@ -11,47 +11,76 @@ GLuint GPUHelper::CreateTexture(u32 width, u32 height, u_byte *data)
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+  // Immutable storage, later uploads never reallocate it
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+  if (data)
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
 
   // Unbind texture
   glBindTexture(GL_TEXTURE_2D, 0);
   return id;
 }
 
-GLuint GPUHelper::CompileShader(u32 shader_type, const char *source, const char *name)
+GLuint GPUHelper::CreateStateTexture(u32 width, u32 height, u32 internal_format)
 {
-  GLint success;
-  GLuint shader = glCreateShader(shader_type);
-
-  glShaderSource(shader, 1, &source, nullptr);
-
-  glCompileShader(shader);
-
-  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-  if (!success)
-  {
-    GLchar info_log[512];
-    glGetShaderInfoLog(shader, 512, NULL, info_log);
-    fprintf(stderr, "Error compiling %s:\n%s\n", name, info_log);
-    std::exit(-1);
-  }
-  return shader;
+  GLuint id;
+  glGenTextures(1, &id);
+  glBindTexture(GL_TEXTURE_2D, id);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  glTexStorage2D(GL_TEXTURE_2D, 1, internal_format, width, height);
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return id;
+}
+
+void GPUHelper::UploadState(u32 texture, u32 width, u32 height, u32 type, const void *data)
+{
+  glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+  // Rows of single bytes aren't 4 byte aligned
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, type, data);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void GPUHelper::ClearState(u32 texture)
+{
+  glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+  // Null data clears every channel to 0
+  glClearTexImage(texture, 0, GL_RED, GL_FLOAT, nullptr);
+}
+
+void GPUHelper::CopyState(u32 source, u32 destination, u32 width, u32 height)
+{
+  glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+  glCopyImageSubData(source, GL_TEXTURE_2D, 0, 0, 0, 0,
+                     destination, GL_TEXTURE_2D, 0, 0, 0, 0,
+                     width, height, 1);
+}
+
+void GPUHelper::DownloadState(u32 texture, u32 type, void *data)
+{
+  glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, type, data);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
 }
 
-GLuint GPUHelper::CreateProgram(u32 compute_shader, const char *name)
+std::string GPUHelper::GridDefines(u32 width, u32 height)
 {
-  GLint success;
-  GLuint program = glCreateProgram();
-  glAttachShader(program, compute_shader);
-  glLinkProgram(program);
-
-  glGetProgramiv(program, GL_LINK_STATUS, &success);
-  if (!success)
-  {
-    GLchar info_log[512];
-    glGetProgramInfoLog(program, 512, NULL, info_log);
-    fprintf(stderr, "Error linking %s:\n%s\n", name, info_log);
-    std::exit(-1);
-  }
-  return program;
+  return "#define C_WIDTH " + std::to_string(width) + "\n#define C_HEIGHT " + std::to_string(height) + "\n";
 }
\ No newline at end of file
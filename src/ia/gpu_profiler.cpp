@@ -0,0 +1,118 @@
+#include "ia/gpu_profiler.h"
+
+GPUProfiler::GPUProfiler()
+{
+  slot_ = 0;
+  active_ = -1;
+}
+
+GPUProfiler::~GPUProfiler()
+{
+  for (Section &section : sections_)
+    if (section.queries_[0] != 0)
+      glDeleteQueries(GPU_PROFILER_LATENCY, section.queries_);
+}
+
+u32 GPUProfiler::addSection(const char *name)
+{
+  Section section = {};
+  section.name_ = name;
+  sections_.push_back(section);
+
+  return static_cast<u32>(sections_.size() - 1);
+}
+
+void GPUProfiler::collect(Section &section, u32 slot)
+{
+  if (!section.pending_[slot])
+    return;
+
+  GLint available = 0;
+  glGetQueryObjectiv(section.queries_[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available)
+    return;
+
+  GLuint64 elapsed = 0;
+  glGetQueryObjectui64v(section.queries_[slot], GL_QUERY_RESULT, &elapsed);
+
+  section.samples_[section.next_sample_] = static_cast<f64>(elapsed) / 1000.0;
+  section.next_sample_ = (section.next_sample_ + 1) % GPU_PROFILER_SAMPLES;
+  section.total_samples_ = std::min(section.total_samples_ + 1, static_cast<u32>(GPU_PROFILER_SAMPLES));
+  section.pending_[slot] = false;
+}
+
+void GPUProfiler::begin(u32 section_id)
+{
+  Section &section = sections_[section_id];
+  if (section.queries_[0] == 0)
+    glGenQueries(GPU_PROFILER_LATENCY, section.queries_);
+
+  // The GPU is too far behind, this frame is skipped instead of waiting
+  collect(section, slot_);
+  if (section.pending_[slot_])
+    return;
+
+  glBeginQuery(GL_TIME_ELAPSED, section.queries_[slot_]);
+  active_ = static_cast<s32>(section_id);
+}
+
+void GPUProfiler::end()
+{
+  if (active_ < 0)
+    return;
+
+  glEndQuery(GL_TIME_ELAPSED);
+  sections_[active_].pending_[slot_] = true;
+  active_ = -1;
+}
+
+void GPUProfiler::frame()
+{
+  for (Section &section : sections_)
+    for (u32 slot = 0; slot < GPU_PROFILER_LATENCY; slot++)
+      collect(section, slot);
+
+  slot_ = (slot_ + 1) % GPU_PROFILER_LATENCY;
+}
+
+f64 GPUProfiler::min(u32 section_id) const
+{
+  const Section &section = sections_[section_id];
+  if (section.total_samples_ == 0)
+    return 0.0;
+
+  return *std::min_element(section.samples_, section.samples_ + section.total_samples_);
+}
+
+f64 GPUProfiler::average(u32 section_id) const
+{
+  const Section &section = sections_[section_id];
+  if (section.total_samples_ == 0)
+    return 0.0;
+
+  f64 sum = 0.0;
+  for (u32 i = 0; i < section.total_samples_; i++)
+    sum += section.samples_[i];
+
+  return sum / static_cast<f64>(section.total_samples_);
+}
+
+f64 GPUProfiler::percentile(u32 section_id, f64 percent) const
+{
+  const Section &section = sections_[section_id];
+  if (section.total_samples_ == 0)
+    return 0.0;
+
+  std::vector<f64> sorted(section.samples_, section.samples_ + section.total_samples_);
+  std::sort(sorted.begin(), sorted.end());
+
+  size_t index = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<f64>(sorted.size())));
+  return sorted[std::clamp(index, static_cast<size_t>(1), sorted.size()) - 1];
+}
+
+void GPUProfiler::imgui() const
+{
+  ImGui::Text("GPU time (mcs)   min / avg / p99");
+  for (u32 i = 0; i < sections_.size(); i++)
+    ImGui::Text("  %s: %.1f / %.1f / %.1f", sections_[i].name_, min(i), average(i), percentile(i, 99.0));
+}
@@ -0,0 +1,458 @@
+#include "ia/hashlife.h"
+#include "ia/gpu_helper.h"
+
+#define NO_NODE 0xFFFFFFFFu
+#define DEAD_LEAF 0u
+#define ALIVE_LEAF 1u
+
+bool Hashlife::NodeKey::operator==(const NodeKey &other) const
+{
+  return nw_ == other.nw_ && ne_ == other.ne_ && sw_ == other.sw_ && se_ == other.se_;
+}
+
+size_t Hashlife::NodeKeyHash::operator()(const NodeKey &key) const
+{
+  u64 a = (static_cast<u64>(key.nw_) << 32) | key.ne_;
+  u64 b = (static_cast<u64>(key.sw_) << 32) | key.se_;
+  u64 hash = a * 0x9E3779B97F4A7C15ull;
+  hash ^= b + 0x7F4A7C159E3779B9ull + (hash << 6) + (hash >> 2);
+  return static_cast<size_t>(hash);
+}
+
+Hashlife::Hashlife()
+{
+  step_ = 0;
+  max_nodes_ = 1 << 22;
+  loops_ = 0;
+  width_ = 0;
+  height_ = 0;
+  root_ = NO_NODE;
+  results_step_ = -1;
+  generation_ = 0;
+  texture_dirty_ = false;
+  texture_id_ = 0;
+}
+
+void Hashlife::init(Math::Vec2 win)
+{
+  loops_ = 0;
+  width_ = static_cast<u32>(win.x);
+  height_ = static_cast<u32>(win.y);
+
+  // Default Hashlife config
+  step_ = 10;
+
+  clearNodes();
+  reset();
+}
+
+Hashlife::~Hashlife()
+{
+  if (texture_id_ != 0)
+    glDeleteTextures(1, &texture_id_);
+}
+
+// Quadtree
+///////////////////////////////////////////////////////////////////////////////
+void Hashlife::clearNodes()
+{
+  nodes_.clear();
+  table_.clear();
+  empty_.clear();
+
+  nodes_.push_back(Node{NO_NODE, NO_NODE, NO_NODE, NO_NODE, NO_NODE, 0, 0});
+  nodes_.push_back(Node{NO_NODE, NO_NODE, NO_NODE, NO_NODE, NO_NODE, 0, 1});
+  empty_.push_back(DEAD_LEAF);
+
+  root_ = emptyNode(3);
+  results_step_ = -1;
+}
+
+u32 Hashlife::join(u32 nw, u32 ne, u32 sw, u32 se)
+{
+  NodeKey key = {nw, ne, sw, se};
+  auto found = table_.find(key);
+  if (found != table_.end())
+    return found->second;
+
+  u64 population = nodes_[nw].population_ + nodes_[ne].population_ +
+                   nodes_[sw].population_ + nodes_[se].population_;
+
+  u32 id = static_cast<u32>(nodes_.size());
+  nodes_.push_back(Node{nw, ne, sw, se, NO_NODE, nodes_[nw].level_ + 1, population});
+  table_.emplace(key, id);
+
+  return id;
+}
+
+u32 Hashlife::emptyNode(u32 level)
+{
+  while (empty_.size() <= level)
+  {
+    u32 empty = empty_.back();
+    empty_.push_back(join(empty, empty, empty, empty));
+  }
+
+  return empty_[level];
+}
+
+u32 Hashlife::centre(u32 node)
+{
+  Node n = nodes_[node];
+  return join(nodes_[n.nw_].se_, nodes_[n.ne_].sw_, nodes_[n.sw_].ne_, nodes_[n.se_].nw_);
+}
+
+u32 Hashlife::expand(u32 node)
+{
+  Node n = nodes_[node];
+  u32 border = emptyNode(n.level_ - 1);
+
+  return join(join(border, border, border, n.nw_),
+              join(border, border, n.ne_, border),
+              join(border, n.sw_, border, border),
+              join(n.se_, border, border, border));
+}
+
+boolean Hashlife::centred(u32 node)
+{
+  Node n = nodes_[node];
+  u64 inner = nodes_[nodes_[n.nw_].se_].population_ + nodes_[nodes_[n.ne_].sw_].population_ +
+              nodes_[nodes_[n.sw_].ne_].population_ + nodes_[nodes_[n.se_].nw_].population_;
+
+  return inner == n.population_;
+}
+
+// 4x4 cells, returns the 2x2 centre one generation later
+u32 Hashlife::baseSuccessor(u32 node)
+{
+  Node n = nodes_[node];
+  u32 quadrants[4] = {n.nw_, n.ne_, n.sw_, n.se_};
+
+  u32 cells[4][4];
+  for (u32 y = 0; y < 4; y++)
+  {
+    for (u32 x = 0; x < 4; x++)
+    {
+      const Node &quadrant = nodes_[quadrants[(y >> 1) * 2 + (x >> 1)]];
+      u32 leaves[4] = {quadrant.nw_, quadrant.ne_, quadrant.sw_, quadrant.se_};
+      cells[y][x] = leaves[(y & 1) * 2 + (x & 1)];
+    }
+  }
+
+  u32 next[4];
+  for (u32 y = 1; y <= 2; y++)
+  {
+    for (u32 x = 1; x <= 2; x++)
+    {
+      u32 neighbours = 0;
+      for (u32 ny = y - 1; ny <= y + 1; ny++)
+        for (u32 nx = x - 1; nx <= x + 1; nx++)
+          neighbours += cells[ny][nx];
+      neighbours -= cells[y][x];
+
+      boolean alive = (neighbours == 3) || (cells[y][x] && neighbours == 2);
+      next[(y - 1) * 2 + (x - 1)] = alive ? ALIVE_LEAF : DEAD_LEAF;
+    }
+  }
+
+  return join(next[0], next[1], next[2], next[3]);
+}
+
+// Centre of the node advanced 2^min(step, level - 2) generations
+u32 Hashlife::successor(u32 node)
+{
+  Node n = nodes_[node];
+  if (n.result_ != NO_NODE)
+    return n.result_;
+
+  u32 result = NO_NODE;
+  if (n.level_ == 2)
+  {
+    result = baseSuccessor(node);
+  }
+  else
+  {
+    Node nw = nodes_[n.nw_];
+    Node ne = nodes_[n.ne_];
+    Node sw = nodes_[n.sw_];
+    Node se = nodes_[n.se_];
+
+    // 9 overlapping subnodes one level down
+    u32 n00 = n.nw_;
+    u32 n01 = join(nw.ne_, ne.nw_, nw.se_, ne.sw_);
+    u32 n02 = n.ne_;
+    u32 n10 = join(nw.sw_, nw.se_, sw.nw_, sw.ne_);
+    u32 n11 = join(nw.se_, ne.sw_, sw.ne_, se.nw_);
+    u32 n12 = join(ne.sw_, ne.se_, se.nw_, se.ne_);
+    u32 n20 = n.sw_;
+    u32 n21 = join(sw.ne_, se.nw_, sw.se_, se.sw_);
+    u32 n22 = n.se_;
+
+    // At full speed both halves advance, otherwise only the second one
+    boolean full_speed = static_cast<u32>(results_step_) + 2 >= n.level_;
+    auto first_half = [this, full_speed](u32 sub_node)
+    { return full_speed ? successor(sub_node) : centre(sub_node); };
+
+    u32 c00 = first_half(n00), c01 = first_half(n01), c02 = first_half(n02);
+    u32 c10 = first_half(n10), c11 = first_half(n11), c12 = first_half(n12);
+    u32 c20 = first_half(n20), c21 = first_half(n21), c22 = first_half(n22);
+
+    result = join(successor(join(c00, c01, c10, c11)),
+                  successor(join(c01, c02, c11, c12)),
+                  successor(join(c10, c11, c20, c21)),
+                  successor(join(c11, c12, c21, c22)));
+  }
+
+  nodes_[node].result_ = result;
+  return result;
+}
+
+void Hashlife::clearResults()
+{
+  for (Node &node : nodes_)
+    node.result_ = NO_NODE;
+}
+
+u32 Hashlife::intern(const std::vector<Node> &old_nodes, u32 node, std::vector<u32> &remap)
+{
+  if (remap[node] != NO_NODE)
+    return remap[node];
+
+  const Node &old = old_nodes[node];
+  u32 nw = intern(old_nodes, old.nw_, remap);
+  u32 ne = intern(old_nodes, old.ne_, remap);
+  u32 sw = intern(old_nodes, old.sw_, remap);
+  u32 se = intern(old_nodes, old.se_, remap);
+
+  remap[node] = join(nw, ne, sw, se);
+  return remap[node];
+}
+
+// Keeps only the nodes reachable from the root, memoized results are lost
+void Hashlife::collect()
+{
+  std::vector<Node> old_nodes;
+  old_nodes.swap(nodes_);
+
+  nodes_.reserve(old_nodes.size() / 2);
+  table_.clear();
+  empty_.clear();
+
+  nodes_.push_back(old_nodes[DEAD_LEAF]);
+  nodes_.push_back(old_nodes[ALIVE_LEAF]);
+  empty_.push_back(DEAD_LEAF);
+
+  std::vector<u32> remap(old_nodes.size(), NO_NODE);
+  remap[DEAD_LEAF] = DEAD_LEAF;
+  remap[ALIVE_LEAF] = ALIVE_LEAF;
+
+  root_ = intern(old_nodes, root_, remap);
+}
+///////////////////////////////////////////////////////////////////////////////
+
+void Hashlife::update()
+{
+  update_timer_.startTime();
+  loops_++;
+
+  step_ = std::clamp(step_, 0, HASHLIFE_MAX_STEP);
+  if (step_ != results_step_)
+  {
+    clearResults();
+    results_step_ = step_;
+  }
+
+  // The pattern has to stay inside the result after 2^step generations
+  while (nodes_[root_].level_ < static_cast<u32>(step_) + 3 || !centred(root_))
+    root_ = expand(root_);
+  root_ = expand(root_);
+
+  root_ = successor(root_);
+  generation_ += 1ull << step_;
+
+  if (nodes_.size() > static_cast<size_t>(max_nodes_))
+  {
+    collect();
+    results_step_ = -1;
+  }
+
+  texture_dirty_ = true;
+  update_timer_.stopTime();
+}
+
+void Hashlife::imgui()
+{
+  ImGui::Begin("GPU Automata");
+
+  ImGui::Text("Type - Hashlife (CPU)");
+  ImGui::Text("Update time: %ld mcs", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
+  ImGui::Text("Generation: %llu", static_cast<unsigned long long>(generation_));
+  ImGui::Text("Population: %llu", static_cast<unsigned long long>(population()));
+  ImGui::Text("Nodes: %zu - Level: %u", nodes_.size(), nodes_[root_].level_);
+
+  ImGui::SliderInt("Step (2^n)", &step_, 0, HASHLIFE_MAX_STEP);
+
+  if (Seeder::Imgui(seed_))
+    reset();
+
+  ImGui::End();
+}
+
+void Hashlife::reset()
+{
+  std::vector<f32> cells(static_cast<size_t>(width_) * height_);
+  Seeder::Fill(seed_, width_, height_, true, cells.data());
+
+  staging_.resize(cells.size() * 4);
+
+  u_byte alive = 255;
+  u_byte dead = 0;
+
+  for (size_t i = 0; i < cells.size(); i++)
+  {
+    staging_[i * 4 + 0] = alive;
+    staging_[i * 4 + 1] = alive;
+    staging_[i * 4 + 2] = alive;
+
+    staging_[i * 4 + 3] = (cells[i] > 0.5f) ? alive : dead;
+  }
+
+  setCells(staging_.data());
+}
+
+void Hashlife::clean()
+{
+  clearNodes();
+
+  loops_ = 0;
+  generation_ = 0;
+  texture_dirty_ = true;
+}
+
+u32 Hashlife::build(const u_byte *rgba, u32 level, s64 x, s64 y)
+{
+  s64 size = static_cast<s64>(1) << level;
+  s64 origin_x = static_cast<s64>(width_ / 2);
+  s64 origin_y = static_cast<s64>(height_ / 2);
+
+  if (x + size <= -origin_x || x >= static_cast<s64>(width_) - origin_x ||
+      y + size <= -origin_y || y >= static_cast<s64>(height_) - origin_y)
+    return emptyNode(level);
+
+  if (level == 0)
+  {
+    size_t index = static_cast<size_t>((y + origin_y) * static_cast<s64>(width_) + (x + origin_x));
+    return (rgba[index * 4 + 3] > 127) ? ALIVE_LEAF : DEAD_LEAF;
+  }
+
+  s64 half = size / 2;
+  return join(build(rgba, level - 1, x, y),
+              build(rgba, level - 1, x + half, y),
+              build(rgba, level - 1, x, y + half),
+              build(rgba, level - 1, x + half, y + half));
+}
+
+void Hashlife::draw(u32 node, s64 x, s64 y, u_byte *rgba)
+{
+  const Node n = nodes_[node];
+  if (n.population_ == 0)
+    return;
+
+  s64 size = static_cast<s64>(1) << n.level_;
+  s64 origin_x = static_cast<s64>(width_ / 2);
+  s64 origin_y = static_cast<s64>(height_ / 2);
+
+  if (x + size <= -origin_x || x >= static_cast<s64>(width_) - origin_x ||
+      y + size <= -origin_y || y >= static_cast<s64>(height_) - origin_y)
+    return;
+
+  if (n.level_ == 0)
+  {
+    size_t index = static_cast<size_t>((y + origin_y) * static_cast<s64>(width_) + (x + origin_x));
+    rgba[index * 4 + 3] = 255;
+    return;
+  }
+
+  s64 half = size / 2;
+  draw(n.nw_, x, y, rgba);
+  draw(n.ne_, x + half, y, rgba);
+  draw(n.sw_, x, y + half, rgba);
+  draw(n.se_, x + half, y + half, rgba);
+}
+
+void Hashlife::setCells(const u_byte *rgba)
+{
+  clean();
+
+  u32 level = 3;
+  while ((1u << (level - 1)) < std::max(width_ - width_ / 2, height_ - height_ / 2))
+    level++;
+
+  s64 half = static_cast<s64>(1) << (level - 1);
+  root_ = build(rgba, level, -half, -half);
+}
+
+void Hashlife::getCells(u_byte *rgba)
+{
+  for (size_t i = 0; i < static_cast<size_t>(width_) * height_ * 4; i += 4)
+  {
+    rgba[i + 0] = 255;
+    rgba[i + 1] = 255;
+    rgba[i + 2] = 255;
+    rgba[i + 3] = 0;
+  }
+
+  s64 half = static_cast<s64>(1) << (nodes_[root_].level_ - 1);
+  draw(root_, -half, -half, rgba);
+}
+
+void Hashlife::loadTexture(u32 texture_id)
+{
+  staging_.resize(static_cast<size_t>(width_) * height_ * 4);
+
+  glBindTexture(GL_TEXTURE_2D, texture_id);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, staging_.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  setCells(staging_.data());
+}
+
+void Hashlife::storeTexture(u32 texture_id)
+{
+  staging_.resize(static_cast<size_t>(width_) * height_ * 4);
+  getCells(staging_.data());
+
+  glBindTexture(GL_TEXTURE_2D, texture_id);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, staging_.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+u64 Hashlife::generation() const { return generation_; }
+
+u64 Hashlife::population() const { return nodes_[root_].population_; }
+
+u32 Hashlife::currentTexture()
+{
+  if (texture_id_ == 0)
+  {
+    texture_id_ = GPUHelper::CreateTexture(width_, height_, nullptr);
+    texture_dirty_ = true;
+  }
+
+  if (texture_dirty_)
+  {
+    storeTexture(texture_id_);
+    texture_dirty_ = false;
+  }
+
+  return texture_id_;
+}
+
+// The hash table is counted as its entries, the buckets are left out
+u64 Hashlife::memoryUsage() const
+{
+  u64 nodes = nodes_.capacity() * sizeof(Node);
+  u64 table = table_.size() * (sizeof(NodeKey) + sizeof(u32));
+  u64 texture = (texture_id_ != 0) ? static_cast<u64>(width_) * height_ * 4 : 0;
+  return nodes + table + staging_.capacity() + texture;
+}
@@ -0,0 +1,102 @@
+#include "ia/kernel_table.h"
+#include "ia/defines.h"
+
+KernelTable::KernelTable()
+{
+  radius_ = -1.0f;
+  rho_ = -1.0f;
+  omega_ = -1.0f;
+  extent_ = 0;
+  uploaded_ = false;
+  ssbo_ = 0;
+  ssbo_size_ = 0;
+}
+
+KernelTable::~KernelTable()
+{
+  if (ssbo_ != 0)
+    glDeleteBuffers(1, &ssbo_);
+}
+
+boolean KernelTable::update(f32 radius, f32 rho, f32 omega)
+{
+  static const std::vector<f32> single_ring = {1.0f};
+  return update(radius, rho, omega, single_ring);
+}
+
+boolean KernelTable::update(f32 radius, f32 rho, f32 omega, const std::vector<f32> &peaks)
+{
+  if (radius == radius_ && rho == rho_ && omega == omega_ && peaks == peaks_)
+    return false;
+
+  radius_ = radius;
+  rho_ = rho;
+  omega_ = omega;
+  peaks_ = peaks;
+  extent_ = static_cast<s32>(radius);
+
+  s32 rings = static_cast<s32>(peaks_.size());
+
+  s32 side = extent_ * 2 + 1;
+  weights_.assign(static_cast<size_t>(side) * static_cast<size_t>(side), 0.0f);
+
+  f32 total = 0.0f;
+  for (s32 y = -extent_; y <= extent_; y++)
+  {
+    for (s32 x = -extent_; x <= extent_; x++)
+    {
+      f32 fx = static_cast<f32>(x);
+      f32 fy = static_cast<f32>(y);
+      f32 ring_rad = (EuclidianDistance(fx, fy) / radius_) * static_cast<f32>(rings);
+      s32 ring = std::min(static_cast<s32>(ring_rad), rings - 1);
+      f32 norm_rad = ring_rad - static_cast<f32>(ring);
+      f32 weight = peaks_[ring] * GaussBell(norm_rad, rho_, omega_);
+
+      weights_[ARRAY_2D_INDEX(x + extent_, y + extent_, side)] = weight;
+      total += weight;
+    }
+  }
+
+  for (f32 &weight : weights_)
+    weight /= total;
+
+  uploaded_ = false;
+  return true;
+}
+
+void KernelTable::bind(u32 binding)
+{
+  if (!uploaded_)
+  {
+    size_t size = weights_.size() * sizeof(f32);
+
+    if (ssbo_ == 0)
+      glGenBuffers(1, &ssbo_);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo_);
+    if (size > ssbo_size_)
+    {
+      glBufferData(GL_SHADER_STORAGE_BUFFER, size, weights_.data(), GL_DYNAMIC_DRAW);
+      ssbo_size_ = size;
+    }
+    else
+    {
+      glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, weights_.data());
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    uploaded_ = true;
+  }
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, ssbo_);
+}
+
+s32 KernelTable::extent() const
+{
+  return extent_;
+}
+
+const std::vector<f32> &KernelTable::weights() const
+{
+  return weights_;
+}
@@ -1,8 +1,27 @@
 #include "ia/lenia.h"
 #include "ia/gpu_helper.h"
+#include "ia/program_batch.h"
 #include "ia/defines.h"
 
-Lenia::Lenia() {}
+#define LENIA_MIN_TILE 8
+#define LENIA_MAX_TILE 32
+
+Lenia::Lenia()
+{
+  shared_memory_ = true;
+  tile_size_ = 16;
+  tiled_program_ = 0;
+  tiled_program_size_ = 0;
+
+  loops_ = 0;
+  compute_program_ = 0;
+  width_ = 0;
+  height_ = 0;
+  prev_data_id_ = 0;
+  current_data_id_ = 0;
+
+  automata_section_ = profiler_.addSection("Automata");
+}
 
 void Lenia::init(Math::Vec2 win)
 {
@@ -10,22 +29,14 @@ void Lenia::init(Math::Vec2 win)
   width_ = static_cast<u32>(win.x);
   height_ = static_cast<u32>(win.y);
 
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
-
-  if (!data)
-  {
-    width_ = 0;
-    height_ = 0;
-
-    return;
-  }
-
-  current_data_id_ = GPUHelper::CreateTexture(width_, height_, data);
-  prev_data_id_ = GPUHelper::CreateTexture(width_, height_, data);
+  current_data_id_ = GPUHelper::CreateStateTexture(width_, height_, CONTINUOUS_STATE_FORMAT);
+  prev_data_id_ = GPUHelper::CreateStateTexture(width_, height_, CONTINUOUS_STATE_FORMAT);
 
-  DESTROY(data);
+  color_map_.init(width_, height_);
 
-  compileShaders();
+  // Without its programs the engine doesn't step, F5 builds them again
+  if (!compileShaders() && !ready())
+    fprintf(stderr, "Lenia can't step, its programs didn't build\n");
 
   // Default Lenia config
   radius_ = 15.0f;
@@ -40,7 +51,18 @@ void Lenia::init(Math::Vec2 win)
   reset();
 }
 
-Lenia::~Lenia() {}
+Lenia::~Lenia()
+{
+  if (compute_program_ != 0)
+    glDeleteProgram(compute_program_);
+  if (tiled_program_ != 0)
+    glDeleteProgram(tiled_program_);
+
+  if (prev_data_id_ != 0)
+    glDeleteTextures(1, &prev_data_id_);
+  if (current_data_id_ != 0)
+    glDeleteTextures(1, &current_data_id_);
+}
 
 void Lenia::swap()
 {
@@ -49,6 +71,9 @@ void Lenia::swap()
 
 void Lenia::update()
 {
+  if (!ready())
+    return;
+
   update_timer_.startTime();
   loops_++;
 
@@ -58,30 +83,44 @@ void Lenia::update()
 
   // GPU Automata
   /////////////////////////////////////////////////////////////////////////////
-  glUseProgram(compute_program_);
+  kernel_.update(radius_, rho_, omega_);
+  kernel_.bind(KERNEL_BIND);
+
+  // The halo of bigger kernels doesn't fit in the shared tile
+  boolean tiled = shared_memory_ && kernel_.extent() <= LENIA_MAX_RADIUS;
+  if (tiled)
+    compileTiledShader();
+
+  u32 program = tiled ? tiled_program_ : compute_program_;
+  glUseProgram(program);
 
-  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
-  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, CONTINUOUS_STATE_FORMAT);
+  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, CONTINUOUS_STATE_FORMAT);
 
-  glUniform1f(glGetUniformLocation(compute_program_, "u_radius"), radius_);
-  glUniform1f(glGetUniformLocation(compute_program_, "u_dt"), dt_);
-  glUniform1f(glGetUniformLocation(compute_program_, "u_mu"), mu_);
-  glUniform1f(glGetUniformLocation(compute_program_, "u_sigma"), sigma_);
-  glUniform1f(glGetUniformLocation(compute_program_, "u_rho"), rho_);
-  glUniform1f(glGetUniformLocation(compute_program_, "u_omega"), omega_);
+  AutomataParams params = {};
+  params.extent_ = kernel_.extent();
+  params.dt_ = dt_;
+  params.mu_ = mu_;
+  params.sigma_ = sigma_;
+  param_block_.bind(PARAMS_BIND, params);
 
   // Dispatch Compute Shader with appropriate workgroup sizes
-  glDispatchCompute(width_ / X_THREADS, height_ / Y_THREADS, 1);
+  profiler_.begin(automata_section_);
+  if (tiled)
+    glDispatchCompute(DISPATCH_GROUPS(width_, tile_size_), DISPATCH_GROUPS(height_, tile_size_), 1);
+  else
+    glDispatchCompute(DISPATCH_GROUPS(width_, X_THREADS), DISPATCH_GROUPS(height_, Y_THREADS), 1);
+  profiler_.end();
   error = glGetError();
   if (error != GL_NO_ERROR)
     fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
 
-  glMemoryBarrier(GL_ALL_BARRIER_BITS);
+  glMemoryBarrier(STEP_BARRIER_BITS);
 
   glUseProgram(0);
   /////////////////////////////////////////////////////////////////////////////
 
-  glFinish();
+  profiler_.frame();
   update_timer_.stopTime();
 }
 
@@ -90,15 +129,30 @@ void Lenia::imgui()
   ImGui::Begin("GPU Automata");
 
   ImGui::Text("Type - Lenia");
-  ImGui::Text("Update time: %ld mcs", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
+  ImGui::Text("CPU time: %ld mcs", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
   ImGui::Text("Generation: %d", loops_);
+  profiler_.imgui();
+
+  ImGui::Checkbox("Shared memory", &shared_memory_);
+  if (shared_memory_)
+  {
+    ImGui::Text("Tile size");
+    for (s32 size = LENIA_MIN_TILE; size <= LENIA_MAX_TILE; size *= 2)
+    {
+      ImGui::SameLine();
+      ImGui::RadioButton(std::to_string(size).c_str(), &tile_size_, size);
+    }
+  }
 
   ImGui::SliderFloat("Radius", &radius_, 10.0f, 25.0f);
   ImGui::SliderFloat("Delta Time", &dt_, 5.0f, 15.0f);
   ImGui::SliderFloat("Mu", &mu_, 0.14f, 0.7f);
   ImGui::SliderFloat("Sigma", &sigma_, 0.014f, 0.07f);
   ImGui::SliderFloat("Rho", &rho_, 0.025f, 0.075f);
-  ImGui::SliderFloat("Omega", &omega_, 0.05f, 0.025f);
+  ImGui::SliderFloat("Omega", &omega_, 0.025f, 0.25f);
+
+  if (Seeder::Imgui(seed_))
+    reset();
 
   ImGui::End();
 }
@@ -106,61 +160,84 @@ void Lenia::imgui()
 void Lenia::reset()
 {
   loops_ = 0;
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
+  f32 *data = reinterpret_cast<f32 *>(staging_.map(static_cast<size_t>(width_) * height_ * sizeof(f32)));
 
   if (!data)
     return;
 
-  u_byte alive = 255;
-
-  for (u32 i = 0; i < width_ * height_ * 4; i += 4)
-  {
-    data[i + 0] = alive;
-    data[i + 1] = alive;
-    data[i + 2] = alive;
+  Seeder::Fill(seed_, width_, height_, false, data);
 
-    data[i + 3] = static_cast<u_byte>(rand() % 255);
-  }
-
-  glBindTexture(GL_TEXTURE_2D, current_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+  staging_.upload(current_data_id_, width_, height_, GL_FLOAT);
+  GPUHelper::CopyState(current_data_id_, prev_data_id_, width_, height_);
+}
 
-  glBindTexture(GL_TEXTURE_2D, prev_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+void Lenia::clean()
+{
+  GPUHelper::ClearState(current_data_id_);
+  GPUHelper::ClearState(prev_data_id_);
+}
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+u32 Lenia::currentTexture() { return color_map_.apply(current_data_id_); }
 
-  DESTROY(data);
+u64 Lenia::memoryUsage() const
+{
+  u64 cells = static_cast<u64>(width_) * height_;
+  return cells * 2 * 2 + staging_.size() + color_map_.memoryUsage();
 }
 
-void Lenia::clean()
+void Lenia::setCells(const f32 *cells)
 {
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
+  GPUHelper::UploadState(current_data_id_, width_, height_, GL_FLOAT, cells);
+  GPUHelper::UploadState(prev_data_id_, width_, height_, GL_FLOAT, cells);
+}
 
-  if (!data)
-    return;
+void Lenia::getCells(f32 *cells) { GPUHelper::DownloadState(current_data_id_, GL_FLOAT, cells); }
 
-  glBindTexture(GL_TEXTURE_2D, current_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+boolean Lenia::ready() const { return compute_program_ != 0; }
 
-  glBindTexture(GL_TEXTURE_2D, prev_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+boolean Lenia::compileShaders()
+{
+  ProgramBatch batch;
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  // Compute shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string lenia_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/lenia/lenia_cs.glsl"));
 
-  DESTROY(data);
-}
+  batch.add(&compute_program_, lenia_string, "lenia program");
+  /////////////////////////////////////////////////////////////////////////////
 
-u32 Lenia::currentTexture() { return current_data_id_; }
+  boolean built = batch.finish();
+  return compileTiledShader(true) && built;
+}
 
-void Lenia::compileShaders()
+// The workgroup size is part of the shader, it is compiled again when the tile changes
+boolean Lenia::compileTiledShader(boolean rebuild)
 {
-  // Compute shader
+  tile_size_ = std::clamp(tile_size_, LENIA_MIN_TILE, LENIA_MAX_TILE);
+  if (!rebuild && tiled_program_size_ == tile_size_)
+    return true;
+
+  ProgramBatch batch;
+
+  // Tiled compute shader
   /////////////////////////////////////////////////////////////////////////////
-  std::string lenia_string = defines + LoadSourceFromFile(SHADER("ia/lenia/lenia_cs.glsl"));
-  const char *lenia_cs = lenia_string.c_str();
+  std::string tile_define = "#define LENIA_TILE " + std::to_string(tile_size_) + "\n";
+  std::string tiled_string = defines + GPUHelper::GridDefines(width_, height_) + tile_define + LoadSourceFromFile(SHADER("ia/lenia/lenia_tiled_cs.glsl"));
 
-  GLuint compute_shader = GPUHelper::CompileShader(GL_COMPUTE_SHADER, lenia_cs, "lenia shader");
-  compute_program_ = GPUHelper::CreateProgram(compute_shader, "lenia program");
+  batch.add(&tiled_program_, tiled_string, "lenia tiled program");
   /////////////////////////////////////////////////////////////////////////////
+
+  // The old program keeps running with its own tile, without one the tile is turned off
+  if (!batch.finish())
+  {
+    if (tiled_program_ != 0)
+      tile_size_ = tiled_program_size_;
+    else
+      shared_memory_ = false;
+
+    return false;
+  }
+
+  tiled_program_size_ = tile_size_;
+  return true;
 }
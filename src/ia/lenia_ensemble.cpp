@@ -0,0 +1,330 @@
+#include "ia/lenia_ensemble.h"
+#include "ia/gpu_helper.h"
+#include "ia/program_batch.h"
+#include "ia/defines.h"
+
+LeniaEnsemble::LeniaEnsemble()
+{
+  // 64 worlds of 128^2 fill the default grid
+  worlds_ = 64;
+
+  radius_ = 13.0f;
+  rho_ = 0.5f;
+  omega_ = 0.15f;
+
+  mu_min_ = 0.1f;
+  mu_max_ = 0.3f;
+  sigma_min_ = 0.01f;
+  sigma_max_ = 0.05f;
+  dt_ = 10.0f;
+
+  loops_ = 0;
+  compute_program_ = 0;
+  stats_program_ = 0;
+  params_ssbo_ = 0;
+  stats_ssbo_ = 0;
+  world_width_ = 0;
+  world_height_ = 0;
+  columns_ = 0;
+  rows_ = 0;
+  width_ = 0;
+  height_ = 0;
+  selected_world_ = 0;
+  prev_data_id_ = 0;
+  current_data_id_ = 0;
+
+  automata_section_ = profiler_.addSection("Automata");
+}
+
+void LeniaEnsemble::init(Math::Vec2 world)
+{
+  loops_ = 0;
+  world_width_ = static_cast<u32>(world.x);
+  world_height_ = static_cast<u32>(world.y);
+
+  GLint max_texture_size = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+
+  // Square atlas, the last row may be partially empty
+  worlds_ = std::clamp(worlds_, 1, ENSEMBLE_MAX_WORLDS);
+  columns_ = static_cast<u32>(std::ceil(std::sqrt(static_cast<f32>(worlds_))));
+  rows_ = DISPATCH_GROUPS(worlds_, columns_);
+  width_ = columns_ * world_width_;
+  height_ = rows_ * world_height_;
+
+  if (width_ > static_cast<u32>(max_texture_size) || height_ > static_cast<u32>(max_texture_size))
+    fprintf(stderr, "Ensemble atlas of %ux%u is bigger than the max texture size %d\n", width_, height_, max_texture_size);
+
+  current_data_id_ = GPUHelper::CreateStateTexture(width_, height_, CONTINUOUS_STATE_FORMAT);
+  prev_data_id_ = GPUHelper::CreateStateTexture(width_, height_, CONTINUOUS_STATE_FORMAT);
+
+  color_map_.init(width_, height_);
+
+  // Without its programs the engine doesn't step, F5 builds them again
+  if (!compileShaders() && !ready())
+    fprintf(stderr, "Lenia ensemble can't step, its programs didn't build\n");
+
+  // One record per world
+  /////////////////////////////////////////////////////////////////////////////
+  glGenBuffers(1, &params_ssbo_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, params_ssbo_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, worlds_ * sizeof(EnsembleParams), nullptr, GL_DYNAMIC_DRAW);
+
+  glGenBuffers(1, &stats_ssbo_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, stats_ssbo_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, worlds_ * sizeof(EnsembleStats), nullptr, GL_DYNAMIC_READ);
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  /////////////////////////////////////////////////////////////////////////////
+
+  stats_.assign(worlds_, EnsembleStats{0.0f, 0.0f, 0.0f, 0.0f});
+  uploaded_params_.clear();
+  sweep();
+
+  reset();
+}
+
+LeniaEnsemble::~LeniaEnsemble()
+{
+  if (params_ssbo_ != 0)
+    glDeleteBuffers(1, &params_ssbo_);
+  if (stats_ssbo_ != 0)
+    glDeleteBuffers(1, &stats_ssbo_);
+
+  if (compute_program_ != 0)
+    glDeleteProgram(compute_program_);
+  if (stats_program_ != 0)
+    glDeleteProgram(stats_program_);
+
+  if (prev_data_id_ != 0)
+    glDeleteTextures(1, &prev_data_id_);
+  if (current_data_id_ != 0)
+    glDeleteTextures(1, &current_data_id_);
+}
+
+void LeniaEnsemble::swap()
+{
+  std::swap(current_data_id_, prev_data_id_);
+}
+
+void LeniaEnsemble::sweep()
+{
+  params_.resize(worlds_);
+
+  u32 sweep_rows = std::max(rows_, 1u);
+  for (s32 world = 0; world < worlds_; world++)
+  {
+    u32 column = static_cast<u32>(world) % columns_;
+    u32 row = static_cast<u32>(world) / columns_;
+
+    f32 mu_step = (columns_ > 1) ? static_cast<f32>(column) / static_cast<f32>(columns_ - 1) : 0.0f;
+    f32 sigma_step = (sweep_rows > 1) ? static_cast<f32>(row) / static_cast<f32>(sweep_rows - 1) : 0.0f;
+
+    params_[world].mu_ = mu_min_ + (mu_max_ - mu_min_) * mu_step;
+    params_[world].sigma_ = sigma_min_ + (sigma_max_ - sigma_min_) * sigma_step;
+    params_[world].dt_ = dt_;
+    params_[world].padding_ = 0.0f;
+  }
+}
+
+// Only when the records changed since the last step
+void LeniaEnsemble::uploadParams()
+{
+  params_.resize(worlds_, EnsembleParams{mu_min_, sigma_min_, dt_, 0.0f});
+
+  if (uploaded_params_.size() == params_.size() &&
+      std::memcmp(uploaded_params_.data(), params_.data(), params_.size() * sizeof(EnsembleParams)) == 0)
+    return;
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, params_ssbo_);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, params_.size() * sizeof(EnsembleParams), params_.data());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  uploaded_params_ = params_;
+}
+
+void LeniaEnsemble::update()
+{
+  if (!ready())
+    return;
+
+  update_timer_.startTime();
+  loops_++;
+
+  swap();
+
+  GLenum error = GL_NO_ERROR;
+
+  // GPU Automata
+  /////////////////////////////////////////////////////////////////////////////
+  // The halo has to fit in the shared tile
+  radius_ = std::min(radius_, static_cast<f32>(LENIA_MAX_RADIUS));
+  kernel_.update(radius_, rho_, omega_);
+  kernel_.bind(KERNEL_BIND);
+
+  uploadParams();
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ENSEMBLE_PARAMS_BIND, params_ssbo_);
+
+  glUseProgram(compute_program_);
+
+  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, CONTINUOUS_STATE_FORMAT);
+  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, CONTINUOUS_STATE_FORMAT);
+
+  AutomataParams params = {};
+  params.extent_ = kernel_.extent();
+  param_block_.bind(PARAMS_BIND, params);
+
+  // Every world in the same dispatch
+  profiler_.begin(automata_section_);
+  glDispatchCompute(DISPATCH_GROUPS(world_width_, ENSEMBLE_TILE), DISPATCH_GROUPS(world_height_, ENSEMBLE_TILE), worlds_);
+  profiler_.end();
+  error = glGetError();
+  if (error != GL_NO_ERROR)
+    fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
+
+  glMemoryBarrier(STEP_BARRIER_BITS);
+
+  glUseProgram(0);
+  /////////////////////////////////////////////////////////////////////////////
+
+  profiler_.frame();
+  update_timer_.stopTime();
+}
+
+const std::vector<EnsembleStats> &LeniaEnsemble::statistics()
+{
+  if (!ready())
+    return stats_;
+
+  // GPU Statistics
+  /////////////////////////////////////////////////////////////////////////////
+  glUseProgram(stats_program_);
+
+  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, CONTINUOUS_STATE_FORMAT);
+  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, CONTINUOUS_STATE_FORMAT);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ENSEMBLE_STATS_BIND, stats_ssbo_);
+
+  glDispatchCompute(worlds_, 1, 1);
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+  glUseProgram(0);
+  /////////////////////////////////////////////////////////////////////////////
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, stats_ssbo_);
+  glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, stats_.size() * sizeof(EnsembleStats), stats_.data());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  return stats_;
+}
+
+void LeniaEnsemble::imgui()
+{
+  ImGui::Begin("GPU Automata");
+
+  ImGui::Text("Type - Lenia ensemble");
+  ImGui::Text("CPU time: %ld mcs", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
+  ImGui::Text("Generation: %d", loops_);
+  ImGui::Text("Worlds: %d of %ux%u", worlds_, world_width_, world_height_);
+  profiler_.imgui();
+
+  ImGui::SliderFloat("Radius", &radius_, 10.0f, static_cast<f32>(LENIA_MAX_RADIUS));
+  ImGui::SliderFloat("Rho", &rho_, 0.025f, 0.75f);
+  ImGui::SliderFloat("Omega", &omega_, 0.025f, 0.25f);
+
+  ImGui::Separator();
+  ImGui::SliderFloat("Mu min", &mu_min_, 0.05f, 0.7f);
+  ImGui::SliderFloat("Mu max", &mu_max_, 0.05f, 0.7f);
+  ImGui::SliderFloat("Sigma min", &sigma_min_, 0.005f, 0.07f);
+  ImGui::SliderFloat("Sigma max", &sigma_max_, 0.005f, 0.07f);
+  ImGui::SliderFloat("Delta Time", &dt_, 5.0f, 15.0f);
+  if (ImGui::Button("Sweep"))
+    sweep();
+
+  ImGui::Separator();
+  ImGui::SliderInt("World", &selected_world_, 0, worlds_ - 1);
+  selected_world_ = std::clamp(selected_world_, 0, worlds_ - 1);
+
+  const EnsembleParams &params = params_[selected_world_];
+  ImGui::Text("Mu %.4f - Sigma %.4f - Dt %.2f", params.mu_, params.sigma_, params.dt_);
+  if (ImGui::Button("Statistics"))
+    statistics();
+  const EnsembleStats &stats = stats_[selected_world_];
+  ImGui::Text("Mass %.4f - Variance %.4f - Activity %.5f", stats.mass_, stats.variance_, stats.activity_);
+
+  if (Seeder::Imgui(seed_))
+    reset();
+
+  ImGui::End();
+}
+
+void LeniaEnsemble::reset()
+{
+  loops_ = 0;
+  f32 *data = reinterpret_cast<f32 *>(staging_.map(static_cast<size_t>(width_) * height_ * sizeof(f32)));
+
+  if (!data)
+    return;
+
+  // One stream per world, the cells of the empty atlas slots stay dead
+  std::fill(data, data + static_cast<size_t>(width_) * height_, 0.0f);
+  for (s32 world = 0; world < worlds_; world++)
+  {
+    u32 origin_x = (static_cast<u32>(world) % columns_) * world_width_;
+    u32 origin_y = (static_cast<u32>(world) / columns_) * world_height_;
+
+    Seeder::Fill(seed_, world_width_, world_height_, false, data + ARRAY_2D_INDEX(origin_x, origin_y, width_), world, width_);
+  }
+
+  staging_.upload(current_data_id_, width_, height_, GL_FLOAT);
+  GPUHelper::CopyState(current_data_id_, prev_data_id_, width_, height_);
+}
+
+void LeniaEnsemble::clean()
+{
+  GPUHelper::ClearState(current_data_id_);
+  GPUHelper::ClearState(prev_data_id_);
+}
+
+void LeniaEnsemble::setCells(const f32 *cells)
+{
+  GPUHelper::UploadState(current_data_id_, width_, height_, GL_FLOAT, cells);
+  GPUHelper::UploadState(prev_data_id_, width_, height_, GL_FLOAT, cells);
+}
+
+void LeniaEnsemble::getCells(f32 *cells) { GPUHelper::DownloadState(current_data_id_, GL_FLOAT, cells); }
+
+u32 LeniaEnsemble::currentTexture() { return color_map_.apply(current_data_id_); }
+
+u64 LeniaEnsemble::memoryUsage() const
+{
+  u64 cells = static_cast<u64>(width_) * height_;
+  return cells * 2 * 2 + static_cast<u64>(worlds_) * (sizeof(EnsembleParams) + sizeof(EnsembleStats)) + staging_.size() + color_map_.memoryUsage();
+}
+
+boolean LeniaEnsemble::ready() const { return compute_program_ != 0 && stats_program_ != 0; }
+
+boolean LeniaEnsemble::compileShaders()
+{
+  ProgramBatch batch;
+
+  std::string world_defines = "#define LENIA_TILE " + std::to_string(ENSEMBLE_TILE) + "\n" +
+                              "#define WORLD_WIDTH " + std::to_string(world_width_) + "\n" +
+                              "#define WORLD_HEIGHT " + std::to_string(world_height_) + "\n" +
+                              "#define WORLD_COLUMNS " + std::to_string(columns_) + "\n";
+
+  // Compute shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string ensemble_string = defines + GPUHelper::GridDefines(width_, height_) + world_defines + LoadSourceFromFile(SHADER("ia/lenia ensemble/ensemble_cs.glsl"));
+
+  batch.add(&compute_program_, ensemble_string, "lenia ensemble program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  // Statistics shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string stats_string = defines + GPUHelper::GridDefines(width_, height_) + world_defines + LoadSourceFromFile(SHADER("ia/lenia ensemble/stats_cs.glsl"));
+
+  batch.add(&stats_program_, stats_string, "lenia ensemble statistics program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  return batch.finish();
+}
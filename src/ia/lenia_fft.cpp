@@ -0,0 +1,445 @@
+#include "ia/lenia_fft.h"
+#include "ia/gpu_helper.h"
+#include "ia/program_batch.h"
+#include "ia/parallel.h"
+#include "ia/defines.h"
+
+LeniaFFT::LeniaFFT()
+{
+  loops_ = 0;
+  width_ = 0;
+  height_ = 0;
+  backend_ = FFT_BACKEND_CPU;
+  active_backend_ = FFT_BACKEND_CPU;
+  kernel_uploaded_ = false;
+  gpu_ready_ = false;
+  texture_dirty_ = false;
+  load_program_ = 0;
+  fft_program_ = 0;
+  multiply_program_ = 0;
+  growth_program_ = 0;
+  fft_data_ssbo_ = 0;
+  fft_kernel_ssbo_ = 0;
+  prev_data_id_ = 0;
+  current_data_id_ = 0;
+
+  load_section_ = profiler_.addSection("Load");
+  forward_section_ = profiler_.addSection("Forward FFT");
+  multiply_section_ = profiler_.addSection("Multiply");
+  inverse_section_ = profiler_.addSection("Inverse FFT");
+  growth_section_ = profiler_.addSection("Automata");
+}
+
+void LeniaFFT::init(Math::Vec2 win)
+{
+  loops_ = 0;
+  width_ = static_cast<u32>(win.x);
+  height_ = static_cast<u32>(win.y);
+
+  cells_.assign(static_cast<size_t>(width_) * height_, 0.0f);
+  work_.assign(static_cast<size_t>(width_) * height_, Complex(0.0f, 0.0f));
+  fft_.init(width_, height_);
+
+  // Default Lenia config
+  radius_ = 15.0f;
+  dt_ = 5.0f;
+  mu_ = 0.14f;
+  sigma_ = 0.014f;
+  rho_ = 0.5f;
+  omega_ = 0.15f;
+
+  reset();
+}
+
+LeniaFFT::~LeniaFFT()
+{
+  if (!gpu_ready_)
+    return;
+
+  glDeleteProgram(load_program_);
+  glDeleteProgram(fft_program_);
+  glDeleteProgram(multiply_program_);
+  glDeleteProgram(growth_program_);
+
+  glDeleteBuffers(1, &fft_data_ssbo_);
+  glDeleteBuffers(1, &fft_kernel_ssbo_);
+
+  glDeleteTextures(1, &prev_data_id_);
+  glDeleteTextures(1, &current_data_id_);
+}
+
+boolean LeniaFFT::gpuAvailable() const
+{
+  return FFT::IsPowerOfTwo(width_) && FFT::IsPowerOfTwo(height_) &&
+         width_ <= FFT_MAX_SIZE && height_ <= FFT_MAX_SIZE;
+}
+
+boolean LeniaFFT::gpuBuilt() const
+{
+  return load_program_ != 0 && fft_program_ != 0 && multiply_program_ != 0 && growth_program_ != 0;
+}
+
+// GL objects are only made when needed, the CPU backend runs without context
+boolean LeniaFFT::initGPU()
+{
+  if (gpu_ready_)
+    return gpuBuilt();
+
+  current_data_id_ = GPUHelper::CreateStateTexture(width_, height_, CONTINUOUS_STATE_FORMAT);
+  prev_data_id_ = GPUHelper::CreateStateTexture(width_, height_, CONTINUOUS_STATE_FORMAT);
+
+  color_map_.init(width_, height_);
+
+  if (!compileShaders() && !gpuBuilt())
+    fprintf(stderr, "Lenia FFT GPU programs didn't build, it steps on the CPU\n");
+
+  // FFT data & kernel spectrum
+  /////////////////////////////////////////////////////////////////////////////
+  glGenBuffers(1, &fft_data_ssbo_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, fft_data_ssbo_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, width_ * height_ * sizeof(Complex), nullptr, GL_DYNAMIC_COPY);
+
+  glGenBuffers(1, &fft_kernel_ssbo_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, fft_kernel_ssbo_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, width_ * height_ * sizeof(Complex), nullptr, GL_DYNAMIC_DRAW);
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  /////////////////////////////////////////////////////////////////////////////
+
+  gpu_ready_ = true;
+  kernel_uploaded_ = false;
+  texture_dirty_ = true;
+
+  return gpuBuilt();
+}
+
+void LeniaFFT::swap()
+{
+  std::swap(current_data_id_, prev_data_id_);
+}
+
+// Normalized kernel moved to frequency space, only when radius, rho or omega change
+void LeniaFFT::buildKernel()
+{
+  if (!kernel_.update(radius_, rho_, omega_))
+    return;
+
+  std::vector<Complex> kernel(static_cast<size_t>(width_) * height_, Complex(0.0f, 0.0f));
+
+  s32 extent = kernel_.extent();
+  s32 side = extent * 2 + 1;
+  s32 width = static_cast<s32>(width_);
+  s32 height = static_cast<s32>(height_);
+
+  // Inverse FFT isn't normalized, the size goes in here
+  f32 scale = 1.0f / (static_cast<f32>(width_) * static_cast<f32>(height_));
+
+  for (s32 y = -extent; y <= extent; y++)
+  {
+    for (s32 x = -extent; x <= extent; x++)
+    {
+      f32 weight = kernel_.weights()[ARRAY_2D_INDEX(x + extent, y + extent, side)];
+
+      u32 index = ARRAY_2D_INDEX(((x % width) + width) % width, ((y % height) + height) % height, width_);
+      kernel[index] += Complex(weight * scale, 0.0f);
+    }
+  }
+
+  fft_.forward(kernel.data());
+  kernel_spectrum_.swap(kernel);
+
+  kernel_uploaded_ = false;
+}
+
+// Moves the state to backend_ when it changed
+void LeniaFFT::selectBackend()
+{
+  // Without its programs the GPU backend can't step, the cells stay on the CPU
+  if (backend_ == FFT_BACKEND_GPU && (!gpuAvailable() || !initGPU()))
+    backend_ = FFT_BACKEND_CPU;
+
+  if (backend_ != active_backend_)
+  {
+    if (backend_ == FFT_BACKEND_GPU)
+      uploadCells();
+    else
+      downloadCells();
+    active_backend_ = backend_;
+  }
+}
+
+void LeniaFFT::update()
+{
+  update_timer_.startTime();
+  loops_++;
+
+  selectBackend();
+
+  buildKernel();
+
+  if (active_backend_ == FFT_BACKEND_GPU)
+    updateGPU();
+  else
+    updateCPU();
+
+  update_timer_.stopTime();
+}
+
+void LeniaFFT::updateCPU()
+{
+  // CPU Automata
+  /////////////////////////////////////////////////////////////////////////////
+  u32 count = width_ * height_;
+
+  ParallelFor(count, [this](u32 first, u32 last)
+              {
+                for (u32 i = first; i < last; i++)
+                  work_[i] = Complex(cells_[i], 0.0f); });
+
+  fft_.forward(work_.data());
+
+  ParallelFor(count, [this](u32 first, u32 last)
+              {
+                for (u32 i = first; i < last; i++)
+                  work_[i] *= kernel_spectrum_[i]; });
+
+  fft_.inverse(work_.data());
+
+  ParallelFor(count, [this](u32 first, u32 last)
+              {
+                for (u32 i = first; i < last; i++)
+                {
+                  f32 avg = work_[i].real();
+                  f32 growth = (GaussBell(avg, mu_, sigma_) * 2.0f) - 1.0f;
+                  cells_[i] = std::clamp(cells_[i] + (1.0f / dt_) * growth, 0.0f, 1.0f);
+                } });
+  /////////////////////////////////////////////////////////////////////////////
+
+  texture_dirty_ = true;
+}
+
+void LeniaFFT::dispatchFFT(f32 direction)
+{
+  GLenum error = GL_NO_ERROR;
+
+  glUseProgram(fft_program_);
+  glUniform1f(FFT_DIRECTION_LOCATION, direction);
+
+  // Rows
+  glUniform1i(FFT_AXIS_LOCATION, FFT_AXIS_ROWS);
+  glDispatchCompute(height_, 1, 1);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  // Columns
+  glUniform1i(FFT_AXIS_LOCATION, FFT_AXIS_COLUMNS);
+  glDispatchCompute(width_, 1, 1);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  error = glGetError();
+  if (error != GL_NO_ERROR)
+    fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
+}
+
+void LeniaFFT::updateGPU()
+{
+  swap();
+
+  GLenum error = GL_NO_ERROR;
+  u32 groups_x = DISPATCH_GROUPS(width_, X_THREADS);
+  u32 groups_y = DISPATCH_GROUPS(height_, Y_THREADS);
+
+  if (!kernel_uploaded_)
+  {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, fft_kernel_ssbo_);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, kernel_spectrum_.size() * sizeof(Complex), kernel_spectrum_.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    kernel_uploaded_ = true;
+  }
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FFT_DATA_BIND, fft_data_ssbo_);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FFT_KERNEL_BIND, fft_kernel_ssbo_);
+  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, CONTINUOUS_STATE_FORMAT);
+  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, CONTINUOUS_STATE_FORMAT);
+
+  // GPU Load
+  /////////////////////////////////////////////////////////////////////////////
+  glUseProgram(load_program_);
+
+  profiler_.begin(load_section_);
+  glDispatchCompute(groups_x, groups_y, 1);
+  profiler_.end();
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  /////////////////////////////////////////////////////////////////////////////
+
+  // GPU Convolution
+  /////////////////////////////////////////////////////////////////////////////
+  profiler_.begin(forward_section_);
+  dispatchFFT(-1.0f);
+  profiler_.end();
+
+  glUseProgram(multiply_program_);
+  profiler_.begin(multiply_section_);
+  glDispatchCompute(groups_x, groups_y, 1);
+  profiler_.end();
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  profiler_.begin(inverse_section_);
+  dispatchFFT(1.0f);
+  profiler_.end();
+  /////////////////////////////////////////////////////////////////////////////
+
+  // GPU Automata
+  /////////////////////////////////////////////////////////////////////////////
+  glUseProgram(growth_program_);
+
+  AutomataParams params = {};
+  params.dt_ = dt_;
+  params.mu_ = mu_;
+  params.sigma_ = sigma_;
+  param_block_.bind(PARAMS_BIND, params);
+
+  profiler_.begin(growth_section_);
+  glDispatchCompute(groups_x, groups_y, 1);
+  profiler_.end();
+  error = glGetError();
+  if (error != GL_NO_ERROR)
+    fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
+
+  glMemoryBarrier(STEP_BARRIER_BITS);
+
+  glUseProgram(0);
+  /////////////////////////////////////////////////////////////////////////////
+
+  profiler_.frame();
+}
+
+void LeniaFFT::imgui()
+{
+  ImGui::Begin("GPU Automata");
+
+  ImGui::Text("Type - Lenia FFT");
+  ImGui::Text("%s time: %ld mcs", (active_backend_ == FFT_BACKEND_GPU) ? "CPU" : "Update", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
+  ImGui::Text("Generation: %d", loops_);
+  if (active_backend_ == FFT_BACKEND_GPU)
+    profiler_.imgui();
+
+  ImGui::RadioButton("CPU", &backend_, FFT_BACKEND_CPU);
+  if (gpuAvailable())
+  {
+    ImGui::SameLine();
+    ImGui::RadioButton("GPU", &backend_, FFT_BACKEND_GPU);
+  }
+
+  ImGui::SliderFloat("Radius", &radius_, 10.0f, 25.0f);
+  ImGui::SliderFloat("Delta Time", &dt_, 5.0f, 15.0f);
+  ImGui::SliderFloat("Mu", &mu_, 0.14f, 0.7f);
+  ImGui::SliderFloat("Sigma", &sigma_, 0.014f, 0.07f);
+  ImGui::SliderFloat("Rho", &rho_, 0.025f, 0.075f);
+  ImGui::SliderFloat("Omega", &omega_, 0.025f, 0.25f);
+
+  if (Seeder::Imgui(seed_))
+    reset();
+
+  ImGui::End();
+}
+
+void LeniaFFT::uploadCells()
+{
+  GPUHelper::UploadState(current_data_id_, width_, height_, GL_FLOAT, cells_.data());
+  GPUHelper::CopyState(current_data_id_, prev_data_id_, width_, height_);
+
+  texture_dirty_ = false;
+}
+
+void LeniaFFT::downloadCells()
+{
+  GPUHelper::DownloadState(current_data_id_, GL_FLOAT, cells_.data());
+}
+
+void LeniaFFT::reset()
+{
+  loops_ = 0;
+
+  Seeder::Fill(seed_, width_, height_, false, cells_.data());
+
+  if (active_backend_ == FFT_BACKEND_GPU)
+    uploadCells();
+  texture_dirty_ = true;
+}
+
+void LeniaFFT::clean()
+{
+  std::fill(cells_.begin(), cells_.end(), 0.0f);
+
+  if (active_backend_ == FFT_BACKEND_GPU)
+    uploadCells();
+  texture_dirty_ = true;
+}
+
+void LeniaFFT::setCells(const f32 *cells)
+{
+  selectBackend();
+
+  std::copy(cells, cells + cells_.size(), cells_.begin());
+
+  if (active_backend_ == FFT_BACKEND_GPU)
+    uploadCells();
+  texture_dirty_ = true;
+}
+
+void LeniaFFT::getCells(f32 *cells)
+{
+  if (active_backend_ == FFT_BACKEND_GPU)
+    downloadCells();
+  std::copy(cells_.begin(), cells_.end(), cells);
+}
+
+u32 LeniaFFT::currentTexture()
+{
+  initGPU();
+
+  // The CPU backend shows its cells through the same texture
+  if (active_backend_ == FFT_BACKEND_CPU && texture_dirty_)
+    uploadCells();
+
+  return color_map_.apply(current_data_id_);
+}
+
+u64 LeniaFFT::memoryUsage() const
+{
+  u64 cells = static_cast<u64>(width_) * height_;
+  u64 cpu = cells_.capacity() * sizeof(f32) + (work_.capacity() + kernel_spectrum_.capacity()) * sizeof(Complex);
+  u64 gpu = gpu_ready_ ? cells * (2 * 2 + 2 * sizeof(Complex)) + color_map_.memoryUsage() : 0;
+  return cpu + gpu;
+}
+
+boolean LeniaFFT::compileShaders()
+{
+  ProgramBatch batch;
+
+  // Load shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string load_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/lenia fft/load_cs.glsl"));
+  batch.add(&load_program_, load_string, "lenia fft load program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  // FFT shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string fft_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/lenia fft/fft_cs.glsl"));
+  batch.add(&fft_program_, fft_string, "lenia fft program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  // Multiply shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string multiply_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/lenia fft/multiply_cs.glsl"));
+  batch.add(&multiply_program_, multiply_string, "lenia fft multiply program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  // Growth shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string growth_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/lenia fft/growth_cs.glsl"));
+  batch.add(&growth_program_, growth_string, "lenia fft growth program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  return batch.finish();
+}
@@ -0,0 +1,598 @@
+#include "ia/lenia_multi.h"
+#include "ia/gpu_helper.h"
+#include "ia/program_batch.h"
+#include "ia/parallel.h"
+
+LeniaMulti::LeniaMulti()
+{
+  loops_ = 0;
+  width_ = 0;
+  height_ = 0;
+  plane_size_ = 0;
+  channels_ = 1;
+  dt_ = 5.0f;
+  backend_ = FFT_BACKEND_CPU;
+  active_backend_ = FFT_BACKEND_CPU;
+  built_kernels_ = 0;
+  kernels_uploaded_ = false;
+  gpu_ready_ = false;
+  texture_dirty_ = false;
+  load_program_ = 0;
+  fft_program_ = 0;
+  multiply_program_ = 0;
+  growth_program_ = 0;
+  spectra_ssbo_ = 0;
+  kernel_ssbo_ = 0;
+  potential_ssbo_ = 0;
+  gpu_kernels_ = 0;
+  prev_data_id_ = 0;
+  current_data_id_ = 0;
+
+  load_section_ = profiler_.addSection("Load");
+  forward_section_ = profiler_.addSection("Forward FFT");
+  multiply_section_ = profiler_.addSection("Multiply");
+  inverse_section_ = profiler_.addSection("Inverse FFT");
+  growth_section_ = profiler_.addSection("Automata");
+}
+
+void LeniaMulti::init(Math::Vec2 win)
+{
+  loops_ = 0;
+  width_ = static_cast<u32>(win.x);
+  height_ = static_cast<u32>(win.y);
+  plane_size_ = width_ * height_;
+
+  fft_.init(width_, height_);
+
+  // Default config, every channel grows with its own ring and feeds the next one with two rings
+  channels_ = LENIA_MAX_CHANNELS;
+  dt_ = 5.0f;
+  kernels_.clear();
+  for (s32 channel = 0; channel < channels_; channel++)
+  {
+    kernels_.push_back({channel, channel, 15.0f, 0.5f, 0.15f, {1.0f}, 0.14f, 0.014f, 1.0f});
+    kernels_.push_back({channel, (channel + 1) % channels_, 18.0f, 0.5f, 0.15f, {0.5f, 1.0f}, 0.16f, 0.02f, 0.5f});
+  }
+
+  cells_.assign(static_cast<size_t>(plane_size_) * LENIA_MAX_CHANNELS, 0.0f);
+  spectra_.assign(static_cast<size_t>(plane_size_) * LENIA_MAX_CHANNELS, Complex(0.0f, 0.0f));
+
+  reset();
+}
+
+LeniaMulti::~LeniaMulti()
+{
+  if (!gpu_ready_)
+    return;
+
+  glDeleteProgram(load_program_);
+  glDeleteProgram(fft_program_);
+  glDeleteProgram(multiply_program_);
+  glDeleteProgram(growth_program_);
+
+  glDeleteBuffers(1, &spectra_ssbo_);
+  glDeleteBuffers(1, &kernel_ssbo_);
+  glDeleteBuffers(1, &potential_ssbo_);
+
+  glDeleteTextures(1, &prev_data_id_);
+  glDeleteTextures(1, &current_data_id_);
+}
+
+boolean LeniaMulti::gpuAvailable() const
+{
+  return FFT::IsPowerOfTwo(width_) && FFT::IsPowerOfTwo(height_) &&
+         width_ <= FFT_MAX_SIZE && height_ <= FFT_MAX_SIZE;
+}
+
+boolean LeniaMulti::gpuBuilt() const
+{
+  return load_program_ != 0 && fft_program_ != 0 && multiply_program_ != 0 && growth_program_ != 0;
+}
+
+// GL objects are only made when needed, the CPU backend runs without context
+boolean LeniaMulti::initGPU()
+{
+  if (gpu_ready_)
+    return gpuBuilt();
+
+  current_data_id_ = GPUHelper::CreateStateTexture(width_, height_, MULTI_STATE_FORMAT);
+  prev_data_id_ = GPUHelper::CreateStateTexture(width_, height_, MULTI_STATE_FORMAT);
+
+  color_map_.init(width_, height_, LENIA_MAX_CHANNELS);
+
+  if (!compileShaders() && !gpuBuilt())
+    fprintf(stderr, "Lenia multi GPU programs didn't build, it steps on the CPU\n");
+
+  // Channel spectra, the kernel planes grow with the kernels
+  /////////////////////////////////////////////////////////////////////////////
+  glGenBuffers(1, &spectra_ssbo_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, spectra_ssbo_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, plane_size_ * LENIA_MAX_CHANNELS * sizeof(Complex), nullptr, GL_DYNAMIC_COPY);
+
+  glGenBuffers(1, &kernel_ssbo_);
+  glGenBuffers(1, &potential_ssbo_);
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  /////////////////////////////////////////////////////////////////////////////
+
+  gpu_ready_ = true;
+  gpu_kernels_ = 0;
+  kernels_uploaded_ = false;
+  texture_dirty_ = true;
+
+  return gpuBuilt();
+}
+
+void LeniaMulti::resizeGPU()
+{
+  u32 kernels = static_cast<u32>(kernels_.size());
+  if (kernels <= gpu_kernels_)
+    return;
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, kernel_ssbo_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, plane_size_ * kernels * sizeof(Complex), nullptr, GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, potential_ssbo_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, plane_size_ * kernels * sizeof(Complex), nullptr, GL_DYNAMIC_COPY);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  gpu_kernels_ = kernels;
+  kernels_uploaded_ = false;
+}
+
+void LeniaMulti::swap()
+{
+  std::swap(current_data_id_, prev_data_id_);
+}
+
+// Normalized kernels moved to frequency space, only the ones that changed
+void LeniaMulti::buildKernels()
+{
+  s32 kernels = static_cast<s32>(kernels_.size());
+  kernel_spectra_.resize(static_cast<size_t>(plane_size_) * kernels);
+
+  s32 width = static_cast<s32>(width_);
+  s32 height = static_cast<s32>(height_);
+
+  // Inverse FFT isn't normalized, the size goes in here
+  f32 scale = 1.0f / (static_cast<f32>(width_) * static_cast<f32>(height_));
+
+  for (s32 k = 0; k < kernels; k++)
+  {
+    const LeniaKernel &kernel = kernels_[k];
+    if (!tables_[k].update(kernel.radius_, kernel.rho_, kernel.omega_, kernel.peaks_) && k < built_kernels_)
+      continue;
+
+    Complex *spectrum = kernel_spectra_.data() + static_cast<size_t>(plane_size_) * k;
+    std::fill(spectrum, spectrum + plane_size_, Complex(0.0f, 0.0f));
+
+    s32 extent = tables_[k].extent();
+    s32 side = extent * 2 + 1;
+
+    for (s32 y = -extent; y <= extent; y++)
+    {
+      for (s32 x = -extent; x <= extent; x++)
+      {
+        f32 weight = tables_[k].weights()[ARRAY_2D_INDEX(x + extent, y + extent, side)];
+
+        u32 index = ARRAY_2D_INDEX(((x % width) + width) % width, ((y % height) + height) % height, width_);
+        spectrum[index] += Complex(weight * scale, 0.0f);
+      }
+    }
+
+    fft_.forward(spectrum);
+    kernels_uploaded_ = false;
+  }
+
+  built_kernels_ = kernels;
+}
+
+// Moves the state to backend_ when it changed
+void LeniaMulti::selectBackend()
+{
+  // Without its programs the GPU backend can't step, the cells stay on the CPU
+  if (backend_ == FFT_BACKEND_GPU && (!gpuAvailable() || !initGPU()))
+    backend_ = FFT_BACKEND_CPU;
+
+  if (backend_ != active_backend_)
+  {
+    if (backend_ == FFT_BACKEND_GPU)
+      uploadCells();
+    else
+      downloadCells();
+    active_backend_ = backend_;
+  }
+}
+
+void LeniaMulti::update()
+{
+  update_timer_.startTime();
+  loops_++;
+
+  channels_ = std::clamp(channels_, 1, LENIA_MAX_CHANNELS);
+  if (kernels_.size() > LENIA_MAX_KERNELS)
+    kernels_.resize(LENIA_MAX_KERNELS);
+  for (LeniaKernel &kernel : kernels_)
+  {
+    kernel.source_ = std::clamp(kernel.source_, 0, channels_ - 1);
+    kernel.target_ = std::clamp(kernel.target_, 0, channels_ - 1);
+    if (kernel.peaks_.empty())
+      kernel.peaks_.push_back(1.0f);
+    if (kernel.peaks_.size() > LENIA_MAX_PEAKS)
+      kernel.peaks_.resize(LENIA_MAX_PEAKS);
+  }
+
+  selectBackend();
+
+  buildKernels();
+
+  if (!kernels_.empty())
+  {
+    if (active_backend_ == FFT_BACKEND_GPU)
+      updateGPU();
+    else
+      updateCPU();
+  }
+
+  update_timer_.stopTime();
+}
+
+void LeniaMulti::updateCPU()
+{
+  // CPU Automata
+  /////////////////////////////////////////////////////////////////////////////
+  u32 count = plane_size_;
+  s32 kernels = static_cast<s32>(kernels_.size());
+  potentials_.resize(static_cast<size_t>(plane_size_) * kernels);
+
+  for (s32 channel = 0; channel < channels_; channel++)
+  {
+    const f32 *cells = cells_.data() + static_cast<size_t>(plane_size_) * channel;
+    Complex *spectrum = spectra_.data() + static_cast<size_t>(plane_size_) * channel;
+
+    ParallelFor(count, [cells, spectrum](u32 first, u32 last)
+                {
+                  for (u32 i = first; i < last; i++)
+                    spectrum[i] = Complex(cells[i], 0.0f); });
+
+    fft_.forward(spectrum);
+  }
+
+  for (s32 k = 0; k < kernels; k++)
+  {
+    const Complex *spectrum = spectra_.data() + static_cast<size_t>(plane_size_) * kernels_[k].source_;
+    const Complex *kernel = kernel_spectra_.data() + static_cast<size_t>(plane_size_) * k;
+    Complex *potential = potentials_.data() + static_cast<size_t>(plane_size_) * k;
+
+    ParallelFor(count, [spectrum, kernel, potential](u32 first, u32 last)
+                {
+                  for (u32 i = first; i < last; i++)
+                    potential[i] = spectrum[i] * kernel[i]; });
+
+    fft_.inverse(potential);
+  }
+
+  ParallelFor(count, [this, kernels](u32 first, u32 last)
+              {
+                for (u32 i = first; i < last; i++)
+                {
+                  f32 growth[LENIA_MAX_CHANNELS] = {};
+                  f32 weight[LENIA_MAX_CHANNELS] = {};
+
+                  for (s32 k = 0; k < kernels; k++)
+                  {
+                    const LeniaKernel &kernel = kernels_[k];
+                    f32 avg = potentials_[static_cast<size_t>(plane_size_) * k + i].real();
+
+                    growth[kernel.target_] += kernel.weight_ * ((GaussBell(avg, kernel.mu_, kernel.sigma_) * 2.0f) - 1.0f);
+                    weight[kernel.target_] += kernel.weight_;
+                  }
+
+                  for (s32 channel = 0; channel < channels_; channel++)
+                  {
+                    if (weight[channel] <= 0.0f)
+                      continue;
+
+                    f32 &cell = cells_[static_cast<size_t>(plane_size_) * channel + i];
+                    cell = std::clamp(cell + (1.0f / dt_) * (growth[channel] / weight[channel]), 0.0f, 1.0f);
+                  }
+                } });
+  /////////////////////////////////////////////////////////////////////////////
+
+  texture_dirty_ = true;
+}
+
+void LeniaMulti::dispatchFFT(f32 direction, u32 planes)
+{
+  GLenum error = GL_NO_ERROR;
+
+  glUseProgram(fft_program_);
+  glUniform1f(FFT_DIRECTION_LOCATION, direction);
+
+  // Rows of every plane
+  glUniform1i(FFT_AXIS_LOCATION, FFT_AXIS_ROWS);
+  glDispatchCompute(height_, planes, 1);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  // Columns of every plane
+  glUniform1i(FFT_AXIS_LOCATION, FFT_AXIS_COLUMNS);
+  glDispatchCompute(width_, planes, 1);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  error = glGetError();
+  if (error != GL_NO_ERROR)
+    fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
+}
+
+void LeniaMulti::updateGPU()
+{
+  swap();
+  resizeGPU();
+
+  GLenum error = GL_NO_ERROR;
+  u32 kernels = static_cast<u32>(kernels_.size());
+  u32 groups_x = DISPATCH_GROUPS(width_, X_THREADS);
+  u32 groups_y = DISPATCH_GROUPS(height_, Y_THREADS);
+
+  if (!kernels_uploaded_)
+  {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, kernel_ssbo_);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<size_t>(plane_size_) * kernels * sizeof(Complex), kernel_spectra_.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    kernels_uploaded_ = true;
+  }
+
+  // The multiply and growth programs read the same block
+  MultiParams params = {};
+  params.kernels_ = static_cast<s32>(kernels);
+  params.dt_ = dt_;
+  for (u32 k = 0; k < kernels; k++)
+  {
+    params.sources_[k] = kernels_[k].source_;
+    params.targets_[k] = kernels_[k].target_;
+    params.mu_[k] = kernels_[k].mu_;
+    params.sigma_[k] = kernels_[k].sigma_;
+    params.weights_[k] = kernels_[k].weight_;
+  }
+  param_block_.bind(MULTI_PARAMS_BIND, params);
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FFT_KERNEL_BIND, kernel_ssbo_);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, POTENTIAL_BIND, potential_ssbo_);
+  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, MULTI_STATE_FORMAT);
+  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, MULTI_STATE_FORMAT);
+
+  // GPU Load, every channel at once
+  /////////////////////////////////////////////////////////////////////////////
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FFT_DATA_BIND, spectra_ssbo_);
+  glUseProgram(load_program_);
+
+  profiler_.begin(load_section_);
+  glDispatchCompute(groups_x, groups_y, channels_);
+  profiler_.end();
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  /////////////////////////////////////////////////////////////////////////////
+
+  // GPU Convolution, the transforms and products of every plane go in the same dispatches
+  /////////////////////////////////////////////////////////////////////////////
+  profiler_.begin(forward_section_);
+  dispatchFFT(-1.0f, channels_);
+  profiler_.end();
+
+  glUseProgram(multiply_program_);
+
+  profiler_.begin(multiply_section_);
+  glDispatchCompute(groups_x, groups_y, kernels);
+  profiler_.end();
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FFT_DATA_BIND, potential_ssbo_);
+  profiler_.begin(inverse_section_);
+  dispatchFFT(1.0f, kernels);
+  profiler_.end();
+  /////////////////////////////////////////////////////////////////////////////
+
+  // GPU Automata
+  /////////////////////////////////////////////////////////////////////////////
+  glUseProgram(growth_program_);
+
+  profiler_.begin(growth_section_);
+  glDispatchCompute(groups_x, groups_y, 1);
+  profiler_.end();
+  error = glGetError();
+  if (error != GL_NO_ERROR)
+    fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
+
+  glMemoryBarrier(STEP_BARRIER_BITS);
+
+  glUseProgram(0);
+  /////////////////////////////////////////////////////////////////////////////
+
+  profiler_.frame();
+}
+
+void LeniaMulti::imgui()
+{
+  ImGui::Begin("GPU Automata");
+
+  ImGui::Text("Type - Lenia multi channel");
+  ImGui::Text("%s time: %ld mcs", (active_backend_ == FFT_BACKEND_GPU) ? "CPU" : "Update", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
+  ImGui::Text("Generation: %d", loops_);
+  if (active_backend_ == FFT_BACKEND_GPU)
+    profiler_.imgui();
+
+  ImGui::RadioButton("CPU", &backend_, FFT_BACKEND_CPU);
+  if (gpuAvailable())
+  {
+    ImGui::SameLine();
+    ImGui::RadioButton("GPU", &backend_, FFT_BACKEND_GPU);
+  }
+
+  ImGui::SliderInt("Channels", &channels_, 1, LENIA_MAX_CHANNELS);
+  ImGui::SliderFloat("Delta Time", &dt_, 5.0f, 15.0f);
+
+  for (s32 k = 0; k < static_cast<s32>(kernels_.size()); k++)
+  {
+    LeniaKernel &kernel = kernels_[k];
+    ImGui::PushID(k);
+
+    if (ImGui::CollapsingHeader(("Kernel " + std::to_string(k)).c_str()))
+    {
+      ImGui::SliderInt("Source", &kernel.source_, 0, channels_ - 1);
+      ImGui::SliderInt("Target", &kernel.target_, 0, channels_ - 1);
+      ImGui::SliderFloat("Radius", &kernel.radius_, 10.0f, 25.0f);
+      ImGui::SliderFloat("Rho", &kernel.rho_, 0.025f, 0.75f);
+      ImGui::SliderFloat("Omega", &kernel.omega_, 0.025f, 0.25f);
+      for (size_t peak = 0; peak < kernel.peaks_.size(); peak++)
+        ImGui::SliderFloat(("Peak " + std::to_string(peak)).c_str(), &kernel.peaks_[peak], 0.0f, 1.0f);
+      ImGui::SliderFloat("Mu", &kernel.mu_, 0.05f, 0.7f);
+      ImGui::SliderFloat("Sigma", &kernel.sigma_, 0.005f, 0.07f);
+      ImGui::SliderFloat("Weight", &kernel.weight_, 0.0f, 1.0f);
+
+      if (kernel.peaks_.size() < LENIA_MAX_PEAKS && ImGui::Button("Add ring"))
+        kernel.peaks_.push_back(1.0f);
+      if (kernel.peaks_.size() > 1)
+      {
+        ImGui::SameLine();
+        if (ImGui::Button("Remove ring"))
+          kernel.peaks_.pop_back();
+      }
+      if (ImGui::Button("Remove kernel"))
+      {
+        kernels_.erase(kernels_.begin() + k);
+        ImGui::PopID();
+        break;
+      }
+    }
+
+    ImGui::PopID();
+  }
+
+  if (kernels_.size() < LENIA_MAX_KERNELS && ImGui::Button("Add kernel"))
+    kernels_.push_back({0, 0, 15.0f, 0.5f, 0.15f, {1.0f}, 0.14f, 0.014f, 1.0f});
+
+  if (Seeder::Imgui(seed_))
+    reset();
+
+  ImGui::End();
+}
+
+void LeniaMulti::uploadCells()
+{
+  // Channels are interleaved in the texture
+  std::vector<f32> texels(static_cast<size_t>(plane_size_) * 4, 0.0f);
+  for (s32 channel = 0; channel < LENIA_MAX_CHANNELS; channel++)
+    for (u32 i = 0; i < plane_size_; i++)
+      texels[static_cast<size_t>(i) * 4 + channel] = cells_[static_cast<size_t>(plane_size_) * channel + i];
+
+  glBindTexture(GL_TEXTURE_2D, current_data_id_);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_FLOAT, texels.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+  GPUHelper::CopyState(current_data_id_, prev_data_id_, width_, height_);
+
+  texture_dirty_ = false;
+}
+
+void LeniaMulti::downloadCells()
+{
+  std::vector<f32> texels(static_cast<size_t>(plane_size_) * 4, 0.0f);
+
+  glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+  glBindTexture(GL_TEXTURE_2D, current_data_id_);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, texels.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  for (s32 channel = 0; channel < LENIA_MAX_CHANNELS; channel++)
+    for (u32 i = 0; i < plane_size_; i++)
+      cells_[static_cast<size_t>(plane_size_) * channel + i] = texels[static_cast<size_t>(i) * 4 + channel];
+}
+
+void LeniaMulti::reset()
+{
+  loops_ = 0;
+
+  // One stream per channel so the channels don't start equal
+  std::fill(cells_.begin(), cells_.end(), 0.0f);
+  for (s32 channel = 0; channel < channels_; channel++)
+    Seeder::Fill(seed_, width_, height_, false, cells_.data() + static_cast<size_t>(plane_size_) * channel, channel);
+
+  if (active_backend_ == FFT_BACKEND_GPU)
+    uploadCells();
+  texture_dirty_ = true;
+}
+
+void LeniaMulti::clean()
+{
+  std::fill(cells_.begin(), cells_.end(), 0.0f);
+
+  if (active_backend_ == FFT_BACKEND_GPU)
+    uploadCells();
+  texture_dirty_ = true;
+}
+
+void LeniaMulti::setCells(const f32 *cells)
+{
+  selectBackend();
+
+  std::fill(cells_.begin(), cells_.end(), 0.0f);
+  std::copy(cells, cells + plane_size_, cells_.begin());
+
+  if (active_backend_ == FFT_BACKEND_GPU)
+    uploadCells();
+  texture_dirty_ = true;
+}
+
+void LeniaMulti::getCells(f32 *cells)
+{
+  if (active_backend_ == FFT_BACKEND_GPU)
+    downloadCells();
+  std::copy(cells_.begin(), cells_.begin() + plane_size_, cells);
+}
+
+u32 LeniaMulti::currentTexture()
+{
+  initGPU();
+
+  // The CPU backend shows its cells through the same texture
+  if (active_backend_ == FFT_BACKEND_CPU && texture_dirty_)
+    uploadCells();
+
+  return color_map_.apply(current_data_id_);
+}
+
+u64 LeniaMulti::memoryUsage() const
+{
+  u64 cpu = cells_.capacity() * sizeof(f32) + (kernel_spectra_.capacity() + spectra_.capacity() + potentials_.capacity()) * sizeof(Complex);
+  u64 planes = LENIA_MAX_CHANNELS + 2 * static_cast<u64>(gpu_kernels_);
+  u64 gpu = gpu_ready_ ? static_cast<u64>(plane_size_) * (2 * 4 * 2 + planes * sizeof(Complex)) + color_map_.memoryUsage() : 0;
+  return cpu + gpu;
+}
+
+boolean LeniaMulti::compileShaders()
+{
+  ProgramBatch batch;
+
+  // Load shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string load_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/lenia multi/load_cs.glsl"));
+  batch.add(&load_program_, load_string, "lenia multi load program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  // FFT shader, shared with LeniaFFT
+  /////////////////////////////////////////////////////////////////////////////
+  std::string fft_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/lenia fft/fft_cs.glsl"));
+  batch.add(&fft_program_, fft_string, "lenia multi fft program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  // Multiply shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string multiply_string = defines + GPUHelper::GridDefines(width_, height_) + multi_block + LoadSourceFromFile(SHADER("ia/lenia multi/multiply_cs.glsl"));
+  batch.add(&multiply_program_, multiply_string, "lenia multi multiply program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  // Growth shader
+  /////////////////////////////////////////////////////////////////////////////
+  std::string growth_string = defines + GPUHelper::GridDefines(width_, height_) + multi_block + LoadSourceFromFile(SHADER("ia/lenia multi/growth_cs.glsl"));
+  batch.add(&growth_program_, growth_string, "lenia multi growth program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  return batch.finish();
+}
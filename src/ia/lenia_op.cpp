@@ -1,85 +1,20 @@
 #include "ia/lenia_op.h"
 #include "ia/gpu_helper.h"
+#include "ia/program_batch.h"
 
-LeniaOp::LeniaOp() {}
-
-float LeniaOp::sumOriginal(Pixel *prev_img, u32 x, u32 y)
-{
-  Counter sum = {0.0f, 0.0f};
-
-  for (s32 ny = -radius_; ny <= radius_; ny++)
-  {
-    for (s32 nx = -radius_; nx <= radius_; nx++)
-    {
-      Math::Vec2 neighbour = Math::Vec2(static_cast<float>(nx), static_cast<float>(ny)) + Math::Vec2(static_cast<float>(x), static_cast<float>(y));
-      if (neighbour.y < 0)
-        neighbour.y = (C_HEIGHT + neighbour.y);
-      if (neighbour.y >= C_HEIGHT)
-        neighbour.y -= C_HEIGHT;
-
-      if (neighbour.x < 0)
-        neighbour.x = (C_WIDTH + neighbour.x);
-      if (neighbour.x >= C_WIDTH)
-        neighbour.x -= C_WIDTH;
-
-      float alpha = prev_img[ARRAY_2D_INDEX(neighbour.x, neighbour.y, C_WIDTH)].a;
-
-      float norm_rad = EuclidianDistance(static_cast<float>(nx), static_cast<float>(ny)) / static_cast<float>(radius_);
-      float weight = GaussBell(norm_rad, rho_, omega_);
-
-      sum.live_ += (alpha * weight);
-      sum.count_ += weight;
-    }
-  }
-
-  return sum.live_ / sum.count_;
-}
-
-float LeniaOp::sumCounter(Counter *counter, u32 x, u32 y)
+LeniaOp::LeniaOp()
 {
-  Counter sum = {0.0f, 0.0f};
-
-  for (u32 i = 0; i < TOTAL_LINES(radius_); i++)
-  {
-    u32 index = ARRAY_3D_INDEX(x, y, i, C_HEIGHT, MAX_RADIUS);
-    sum.live_ += counter[index].live_;
-    sum.count_ += counter[index].count_;
-  }
-
-  return sum.live_ / sum.count_;
-}
-
-#if defined(DEBUG)
-void LeniaOp::checkSingleSlot(Counter *counter, Pixel *prev_img, u32 x, u32 y)
-{
-  float sum_original = sumOriginal(prev_img, x, y);
-  float sum_counter = sumCounter(counter, x, y);
-
-  assert(sum_original == sum_counter);
-}
-#else
-void LeniaOp::checkSingleSlot(Counter *, Pixel *, u32, u32) {}
-#endif
-
-void LeniaOp::checkComputeResults()
-{
-  // Use glGetNamedBufferSubData to retrieve data from the buffer for debugging
-  Counter *data = reinterpret_cast<Counter *>(std::calloc(width_ * height_ * MAX_RADIUS, sizeof(Counter)));
-  assert(data);
-  glGetNamedBufferSubData(counter_ssbo_, 0, width_ * height_ * MAX_RADIUS * sizeof(Counter), data);
-
-  // Use glGetTexImage to retrieve data from the image for debugging
-  Pixel *prev_image_data = reinterpret_cast<Pixel *>(std::calloc(width_ * height_, sizeof(Pixel)));
-  assert(prev_image_data);
-  glBindTexture(GL_TEXTURE_2D, prev_data_id_);
-  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, prev_image_data);
-
-  for (u32 y = 0; y < C_WIDTH; y++)
-    for (u32 x = 0; x < C_HEIGHT; x++)
-      checkSingleSlot(data, prev_image_data, x, y);
-
-  DESTROY(data);
-  DESTROY(prev_image_data);
+  loops_ = 0;
+  counter_ssbo_ = 0;
+  pre_compute_program_ = 0;
+  compute_program_ = 0;
+  width_ = 0;
+  height_ = 0;
+  prev_data_id_ = 0;
+  current_data_id_ = 0;
+
+  counter_section_ = profiler_.addSection("Counter");
+  automata_section_ = profiler_.addSection("Automata");
 }
 
 void LeniaOp::init(Math::Vec2 win)
@@ -88,22 +23,14 @@ void LeniaOp::init(Math::Vec2 win)
   width_ = static_cast<u32>(win.x);
   height_ = static_cast<u32>(win.y);
 
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
-
-  if (!data)
-  {
-    width_ = 0;
-    height_ = 0;
-
-    return;
-  }
-
-  current_data_id_ = GPUHelper::CreateTexture(width_, height_, data);
-  prev_data_id_ = GPUHelper::CreateTexture(width_, height_, data);
+  current_data_id_ = GPUHelper::CreateStateTexture(width_, height_, CONTINUOUS_STATE_FORMAT);
+  prev_data_id_ = GPUHelper::CreateStateTexture(width_, height_, CONTINUOUS_STATE_FORMAT);
 
-  DESTROY(data);
+  color_map_.init(width_, height_);
 
-  compileShaders();
+  // Without its programs the engine doesn't step, F5 builds them again
+  if (!compileShaders() && !ready())
+    fprintf(stderr, "Lenia op can't step, its programs didn't build\n");
 
   // Default LeniaOp config
   radius_ = 15;
@@ -119,7 +46,7 @@ void LeniaOp::init(Math::Vec2 win)
   /////////////////////////////////////////////////////////////////////////////
   glGenBuffers(1, &counter_ssbo_);
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, counter_ssbo_);
-  glBufferData(GL_SHADER_STORAGE_BUFFER, width_ * height_ * TOTAL_LINES(MAX_RADIUS) * sizeof(Counter), nullptr, GL_DYNAMIC_COPY);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, width_ * height_ * sizeof(Counter), nullptr, GL_DYNAMIC_COPY);
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNTER_BIND, counter_ssbo_);
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
   /////////////////////////////////////////////////////////////////////////////
@@ -127,7 +54,21 @@ void LeniaOp::init(Math::Vec2 win)
   reset();
 }
 
-LeniaOp::~LeniaOp() {}
+LeniaOp::~LeniaOp()
+{
+  if (pre_compute_program_ != 0)
+    glDeleteProgram(pre_compute_program_);
+  if (compute_program_ != 0)
+    glDeleteProgram(compute_program_);
+
+  if (counter_ssbo_ != 0)
+    glDeleteBuffers(1, &counter_ssbo_);
+
+  if (prev_data_id_ != 0)
+    glDeleteTextures(1, &prev_data_id_);
+  if (current_data_id_ != 0)
+    glDeleteTextures(1, &current_data_id_);
+}
 
 void LeniaOp::swap()
 {
@@ -136,6 +77,9 @@ void LeniaOp::swap()
 
 void LeniaOp::update()
 {
+  if (!ready())
+    return;
+
   update_timer_.startTime();
   loops_++;
 
@@ -144,27 +88,32 @@ void LeniaOp::update()
   GLenum error = GL_NO_ERROR;
 
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNTER_BIND, counter_ssbo_);
-  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
-  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, CONTINUOUS_STATE_FORMAT);
+  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, CONTINUOUS_STATE_FORMAT);
 
   // GPU Counter
   /////////////////////////////////////////////////////////////////////////////
   glUseProgram(pre_compute_program_);
 
-  glUniform1i(glGetUniformLocation(pre_compute_program_, "u_radius"), radius_);
-  glUniform1f(glGetUniformLocation(pre_compute_program_, "u_dt"), dt_);
-  glUniform1f(glGetUniformLocation(pre_compute_program_, "u_mu"), mu_);
-  glUniform1f(glGetUniformLocation(pre_compute_program_, "u_sigma"), sigma_);
-  glUniform1f(glGetUniformLocation(pre_compute_program_, "u_rho"), rho_);
-  glUniform1f(glGetUniformLocation(pre_compute_program_, "u_omega"), omega_);
+  kernel_.update(static_cast<f32>(radius_), rho_, omega_);
+  kernel_.bind(KERNEL_BIND);
+
+  // Both programs read the same block
+  AutomataParams params = {};
+  params.extent_ = radius_;
+  params.dt_ = dt_;
+  params.mu_ = mu_;
+  params.sigma_ = sigma_;
+  param_block_.bind(PARAMS_BIND, params);
 
-  glDispatchCompute(width_ / X_THREADS, height_ / Y_THREADS, TOTAL_LINES(radius_));
+  profiler_.begin(counter_section_);
+  glDispatchCompute(DISPATCH_GROUPS(width_, X_THREADS), DISPATCH_GROUPS(height_, Y_THREADS), 1);
+  profiler_.end();
   error = glGetError();
   if (error != GL_NO_ERROR)
     fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
 
-  glMemoryBarrier(GL_ALL_BARRIER_BITS);
-  // checkComputeResults();
+  glMemoryBarrier(STEP_BARRIER_BITS);
   glUseProgram(0);
   /////////////////////////////////////////////////////////////////////////////
 
@@ -172,25 +121,20 @@ void LeniaOp::update()
   /////////////////////////////////////////////////////////////////////////////
   glUseProgram(compute_program_);
 
-  glUniform1i(glGetUniformLocation(compute_program_, "u_radius"), radius_);
-  glUniform1f(glGetUniformLocation(compute_program_, "u_dt"), dt_);
-  glUniform1f(glGetUniformLocation(compute_program_, "u_mu"), mu_);
-  glUniform1f(glGetUniformLocation(compute_program_, "u_sigma"), sigma_);
-  glUniform1f(glGetUniformLocation(compute_program_, "u_rho"), rho_);
-  glUniform1f(glGetUniformLocation(compute_program_, "u_omega"), omega_);
-
   // Dispatch Compute Shader with appropriate workgroup sizes
-  glDispatchCompute(width_ / X_THREADS, height_ / Y_THREADS, 1);
+  profiler_.begin(automata_section_);
+  glDispatchCompute(DISPATCH_GROUPS(width_, X_THREADS), DISPATCH_GROUPS(height_, Y_THREADS), 1);
+  profiler_.end();
   error = glGetError();
   if (error != GL_NO_ERROR)
     fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
 
-  glMemoryBarrier(GL_ALL_BARRIER_BITS);
+  glMemoryBarrier(STEP_BARRIER_BITS);
 
   glUseProgram(0);
   /////////////////////////////////////////////////////////////////////////////
 
-  glFinish();
+  profiler_.frame();
   update_timer_.stopTime();
 }
 
@@ -199,15 +143,19 @@ void LeniaOp::imgui()
   ImGui::Begin("GPU Automata");
 
   ImGui::Text("Type - Lenia optimized");
-  ImGui::Text("Update time: %ld ms", update_timer_.getElapsedTime(TimeCont::Precision::milliseconds));
+  ImGui::Text("CPU time: %ld mcs", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
   ImGui::Text("Generation: %d", loops_);
+  profiler_.imgui();
 
   ImGui::SliderInt("Radius", &radius_, 10, MAX_RADIUS);
   ImGui::SliderFloat("Delta Time", &dt_, 5.0f, 15.0f);
   ImGui::SliderFloat("Mu", &mu_, 0.14f, 0.7f);
   ImGui::SliderFloat("Sigma", &sigma_, 0.014f, 0.07f);
   ImGui::SliderFloat("Rho", &rho_, 0.025f, 0.075f);
-  ImGui::SliderFloat("Omega", &omega_, 0.05f, 0.025f);
+  ImGui::SliderFloat("Omega", &omega_, 0.025f, 0.25f);
+
+  if (Seeder::Imgui(seed_))
+    reset();
 
   ImGui::End();
 }
@@ -215,69 +163,57 @@ void LeniaOp::imgui()
 void LeniaOp::reset()
 {
   loops_ = 0;
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
+  f32 *data = reinterpret_cast<f32 *>(staging_.map(static_cast<size_t>(width_) * height_ * sizeof(f32)));
 
   if (!data)
     return;
 
-  u_byte alive = 255;
-
-  for (u32 i = 0; i < width_ * height_ * 4; i += 4)
-  {
-    data[i + 0] = alive;
-    data[i + 1] = alive;
-    data[i + 2] = alive;
+  Seeder::Fill(seed_, width_, height_, false, data);
 
-    data[i + 3] = static_cast<u_byte>(rand() % 255);
-  }
-
-  glBindTexture(GL_TEXTURE_2D, current_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-  glBindTexture(GL_TEXTURE_2D, prev_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-
-  DESTROY(data);
+  staging_.upload(current_data_id_, width_, height_, GL_FLOAT);
+  GPUHelper::CopyState(current_data_id_, prev_data_id_, width_, height_);
 }
 
 void LeniaOp::clean()
 {
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
-
-  if (!data)
-    return;
-
-  glBindTexture(GL_TEXTURE_2D, current_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+  GPUHelper::ClearState(current_data_id_);
+  GPUHelper::ClearState(prev_data_id_);
+}
 
-  glBindTexture(GL_TEXTURE_2D, prev_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+u32 LeniaOp::currentTexture() { return color_map_.apply(current_data_id_); }
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+u64 LeniaOp::memoryUsage() const
+{
+  u64 cells = static_cast<u64>(width_) * height_;
+  return cells * (2 * 2 + sizeof(Counter)) + staging_.size() + color_map_.memoryUsage();
+}
 
-  DESTROY(data);
+void LeniaOp::setCells(const f32 *cells)
+{
+  GPUHelper::UploadState(current_data_id_, width_, height_, GL_FLOAT, cells);
+  GPUHelper::UploadState(prev_data_id_, width_, height_, GL_FLOAT, cells);
 }
 
-u32 LeniaOp::currentTexture() { return current_data_id_; }
+void LeniaOp::getCells(f32 *cells) { GPUHelper::DownloadState(current_data_id_, GL_FLOAT, cells); }
+
+boolean LeniaOp::ready() const { return pre_compute_program_ != 0 && compute_program_ != 0; }
 
-void LeniaOp::compileShaders()
+boolean LeniaOp::compileShaders()
 {
+  ProgramBatch batch;
+
   // Pre compute shader
   ///////////////////////////////////////////////////////////////////////////
-  std::string pre_lenia_string = defines + LoadSourceFromFile(SHADER("ia/lenia op/counter_cs.glsl"));
-  const char *pre_lenia_cs = pre_lenia_string.c_str();
+  std::string pre_lenia_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/lenia op/counter_cs.glsl"));
 
-  GLuint pre_compute_shader = GPUHelper::CompileShader(GL_COMPUTE_SHADER, pre_lenia_cs, "lenia counter shader");
-  pre_compute_program_ = GPUHelper::CreateProgram(pre_compute_shader, "lenia counter program");
+  batch.add(&pre_compute_program_, pre_lenia_string, "lenia counter program");
   ///////////////////////////////////////////////////////////////////////////
 
   // Compute shader
   /////////////////////////////////////////////////////////////////////////////
-  std::string lenia_string = defines + LoadSourceFromFile(SHADER("ia/lenia op/lenia_op_cs.glsl"));
-  const char *lenia_cs = lenia_string.c_str();
-  GLuint compute_shader = GPUHelper::CompileShader(GL_COMPUTE_SHADER, lenia_cs, "lenia op shader");
-  compute_program_ = GPUHelper::CreateProgram(compute_shader, "lenia op program");
+  std::string lenia_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/lenia op/lenia_op_cs.glsl"));
+  batch.add(&compute_program_, lenia_string, "lenia op program");
   /////////////////////////////////////////////////////////////////////////////
+
+  return batch.finish();
 }
@@ -0,0 +1,49 @@
+#include "ia/param_block.h"
+
+static u32 uploads = 0;
+
+ParamBlock::ParamBlock()
+{
+  ubo_ = 0;
+}
+
+ParamBlock::~ParamBlock()
+{
+  if (ubo_ != 0)
+    glDeleteBuffers(1, &ubo_);
+}
+
+void ParamBlock::bind(u32 binding, const void *params, size_t size)
+{
+  const u_byte *bytes = static_cast<const u_byte *>(params);
+
+  if (uploaded_.size() != size)
+  {
+    if (ubo_ != 0)
+      glDeleteBuffers(1, &ubo_);
+
+    glGenBuffers(1, &ubo_);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+    glBufferStorage(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), bytes, GL_DYNAMIC_STORAGE_BIT);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    uploaded_.assign(bytes, bytes + size);
+    uploads++;
+  }
+  else if (std::memcmp(uploaded_.data(), bytes, size) != 0)
+  {
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<GLsizeiptr>(size), bytes);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    std::memcpy(uploaded_.data(), bytes, size);
+    uploads++;
+  }
+
+  glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo_);
+}
+
+u32 ParamBlock::Uploads()
+{
+  return uploads;
+}
@@ -0,0 +1,220 @@
+#include "ia/program_batch.h"
+#include <filesystem>
+
+static u32 cache_hits = 0;
+static u32 cache_misses = 0;
+
+// Driver and cache setup, done once with the first batch
+///////////////////////////////////////////////////////////////////////////////
+struct ProgramDriver
+{
+  std::string name_;
+  boolean binaries_;
+};
+
+static const ProgramDriver &Driver()
+{
+  static ProgramDriver driver;
+  static boolean ready = false;
+  if (ready)
+    return driver;
+
+  ready = true;
+
+  const GLubyte *vendor = glGetString(GL_VENDOR);
+  const GLubyte *renderer = glGetString(GL_RENDERER);
+  const GLubyte *version = glGetString(GL_VERSION);
+  driver.name_ = std::string(vendor ? reinterpret_cast<const byte *>(vendor) : "") + "\n" +
+                 (renderer ? reinterpret_cast<const byte *>(renderer) : "") + "\n" +
+                 (version ? reinterpret_cast<const byte *>(version) : "") + "\n";
+
+  GLint formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  driver.binaries_ = formats > 0;
+  if (driver.binaries_)
+  {
+    std::error_code error;
+    std::filesystem::create_directories(PROGRAM_CACHE_DIR, error);
+    driver.binaries_ = !error;
+  }
+
+  GLint extensions = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+  for (GLint i = 0; i < extensions; i++)
+  {
+    const byte *extension = reinterpret_cast<const byte *>(glGetStringi(GL_EXTENSIONS, i));
+    if (extension && strcmp(extension, "GL_KHR_parallel_shader_compile") == 0)
+    {
+      // As many threads as the driver wants
+      glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+      break;
+    }
+  }
+
+  return driver;
+}
+
+// FNV-1a, the driver goes in the key so an update never loads an old binary
+static std::string CachePath(const std::string &source)
+{
+  u64 hash = 14695981039346656037ull;
+  for (const std::string *text : {&Driver().name_, &source})
+  {
+    for (byte c : *text)
+    {
+      hash ^= static_cast<u_byte>(c);
+      hash *= 1099511628211ull;
+    }
+  }
+
+  byte name[32];
+  snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+  return std::string(PROGRAM_CACHE_DIR) + name;
+}
+
+static u32 LoadBinary(const std::string &path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return 0;
+
+  GLenum format = 0;
+  if (!file.read(reinterpret_cast<byte *>(&format), sizeof(format)))
+    return 0;
+
+  std::vector<byte> binary((std::istreambuf_iterator<byte>(file)), std::istreambuf_iterator<byte>());
+  if (binary.empty())
+    return 0;
+
+  GLuint program = glCreateProgram();
+  glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+  // Rejected when the driver changed the format without changing its version string
+  GLint success = 0;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success)
+  {
+    glDeleteProgram(program);
+    return 0;
+  }
+
+  return program;
+}
+
+static void StoreBinary(u32 program, const std::string &path)
+{
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+
+  std::vector<byte> binary(static_cast<size_t>(length));
+  GLenum format = 0;
+  glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const byte *>(&format), sizeof(format));
+  file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+}
+///////////////////////////////////////////////////////////////////////////////
+
+ProgramBatch::ProgramBatch() {}
+
+ProgramBatch::~ProgramBatch()
+{
+  if (!entries_.empty())
+    finish();
+}
+
+void ProgramBatch::add(u32 *program, const std::string &source, const char *name)
+{
+  const ProgramDriver &driver = Driver();
+
+  Entry entry = {};
+  entry.target_ = program;
+  entry.name_ = name;
+
+  if (driver.binaries_)
+  {
+    entry.path_ = CachePath(source);
+    entry.program_ = LoadBinary(entry.path_);
+    entry.cached_ = entry.program_ != 0;
+  }
+
+  // Nothing is queried here, the driver keeps compiling while the next ones are added
+  if (!entry.cached_)
+  {
+    const char *text = source.c_str();
+    entry.shader_ = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(entry.shader_, 1, &text, nullptr);
+    glCompileShader(entry.shader_);
+
+    entry.program_ = glCreateProgram();
+    if (driver.binaries_)
+      glProgramParameteri(entry.program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(entry.program_, entry.shader_);
+    glLinkProgram(entry.program_);
+  }
+
+  entries_.push_back(entry);
+}
+
+boolean ProgramBatch::finish()
+{
+  boolean all_built = true;
+
+  for (Entry &entry : entries_)
+  {
+    if (entry.cached_)
+    {
+      cache_hits++;
+    }
+    else
+    {
+      cache_misses++;
+
+      GLint compiled = 0;
+      glGetShaderiv(entry.shader_, GL_COMPILE_STATUS, &compiled);
+      GLint linked = 0;
+      glGetProgramiv(entry.program_, GL_LINK_STATUS, &linked);
+
+      if (!compiled || !linked)
+      {
+        GLchar info_log[512] = {};
+        if (!compiled)
+          glGetShaderInfoLog(entry.shader_, 512, nullptr, info_log);
+        else
+          glGetProgramInfoLog(entry.program_, 512, nullptr, info_log);
+        fprintf(stderr, "Error building %s:\n%s\n", entry.name_, info_log);
+
+        glDeleteShader(entry.shader_);
+        glDeleteProgram(entry.program_);
+        all_built = false;
+        continue;
+      }
+
+      glDetachShader(entry.program_, entry.shader_);
+      glDeleteShader(entry.shader_);
+
+      if (!entry.path_.empty())
+        StoreBinary(entry.program_, entry.path_);
+    }
+
+    if (*entry.target_ != 0)
+      glDeleteProgram(*entry.target_);
+    *entry.target_ = entry.program_;
+  }
+
+  entries_.clear();
+  return all_built;
+}
+
+u32 ProgramBatch::CacheHits()
+{
+  return cache_hits;
+}
+
+u32 ProgramBatch::CacheMisses()
+{
+  return cache_misses;
+}
@@ -0,0 +1,230 @@
+#include "ia/seed.h"
+#include "ia/parallel.h"
+
+// Different salts so the blobs and squares don't follow the cell values
+#define SEED_BLOB_SALT 0x68bc21ebu
+#define SEED_SOUP_SALT 0x02e5be93u
+
+// Rows expanded to floats at a time by FillBits, every chunk walks all the blobs again
+#define SEED_BITS_ROWS 64u
+
+static const byte *pattern_names[] = {"noise", "blobs", "soup"};
+
+// PCG output permutation, good enough to use the cell index as the counter
+// Positive remainder for any offset, blobs can be several grids wide
+static inline u32 Wrap(s32 value, s32 size)
+{
+  return static_cast<u32>(((value % size) + size) % size);
+}
+
+u32 Seeder::Hash(u32 value)
+{
+  u32 state = value * 747796405u + 2891336453u;
+  u32 word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+  return (word >> 22u) ^ word;
+}
+
+f32 Seeder::Random(u32 seed, u32 stream, u32 counter)
+{
+  u32 hash = Hash(Hash(Hash(seed) ^ stream) ^ counter);
+  return static_cast<f32>(hash >> 8) / 16777216.0f;
+}
+
+// Patterns
+///////////////////////////////////////////////////////////////////////////////
+static f32 CellValue(const SeedConfig &config, u32 stream, u32 x, u32 y, u32 width, boolean binary, f32 alive_chance)
+{
+  f32 value = Seeder::Random(config.seed_, stream, y * width + x);
+  if (binary)
+    return (value < alive_chance) ? 1.0f : 0.0f;
+  return value;
+}
+
+// cells points to first_row, the values still depend on the absolute (x, y)
+static void FillNoise(const SeedConfig &config, u32 width, boolean binary, f32 *cells, u32 stream, u32 stride,
+                      u32 first_row, u32 last_row)
+{
+  for (u32 y = first_row; y < last_row; y++)
+    for (u32 x = 0; x < width; x++)
+      cells[static_cast<size_t>(y - first_row) * stride + x] = CellValue(config, stream, x, y, width, binary, config.density_);
+}
+
+static void FillSoup(const SeedConfig &config, u32 width, boolean binary, f32 *cells, u32 stream, u32 stride,
+                     u32 first_row, u32 last_row)
+{
+  u32 side = static_cast<u32>(std::clamp(config.scale_, SEED_MIN_SCALE, SEED_MAX_SCALE) * 2.0f);
+  u32 squares_x = (width + side - 1) / side;
+
+  for (u32 y = first_row; y < last_row; y++)
+  {
+    for (u32 x = 0; x < width; x++)
+    {
+      u32 square = (y / side) * squares_x + x / side;
+      boolean filled = Seeder::Random(config.seed_ ^ SEED_SOUP_SALT, stream, square) < config.density_;
+      cells[static_cast<size_t>(y - first_row) * stride + x] = filled ? CellValue(config, stream, x, y, width, binary, 0.5f) : 0.0f;
+    }
+  }
+}
+
+// Every band walks all the discs and only writes its own rows, overlapping discs keep the max
+// so the result doesn't depend on the order
+static void FillBlobs(const SeedConfig &config, u32 width, u32 height, boolean binary, f32 *cells, u32 stream, u32 stride,
+                      u32 first_row, u32 last_row)
+{
+  for (u32 y = first_row; y < last_row; y++)
+    std::fill(cells + static_cast<size_t>(y - first_row) * stride, cells + static_cast<size_t>(y - first_row) * stride + width, 0.0f);
+
+  f32 scale = std::clamp(config.scale_, SEED_MIN_SCALE, SEED_MAX_SCALE);
+  f32 area = static_cast<f32>(width) * static_cast<f32>(height);
+  f32 density = std::clamp(config.density_, 0.0f, 1.0f);
+  u32 blobs = std::max(1u, static_cast<u32>(area * density / (3.14159265f * scale * scale)));
+  u32 blob_seed = config.seed_ ^ SEED_BLOB_SALT;
+
+  for (u32 blob = 0; blob < blobs; blob++)
+  {
+    f32 center_x = Seeder::Random(blob_seed, stream, blob * 3 + 0) * static_cast<f32>(width);
+    f32 center_y = Seeder::Random(blob_seed, stream, blob * 3 + 1) * static_cast<f32>(height);
+    f32 radius = scale * (0.5f + 0.5f * Seeder::Random(blob_seed, stream, blob * 3 + 2));
+    s32 extent = static_cast<s32>(radius);
+
+    for (s32 dy = -extent; dy <= extent; dy++)
+    {
+      u32 y = Wrap(static_cast<s32>(center_y) + dy, static_cast<s32>(height));
+      if (y < first_row || y >= last_row)
+        continue;
+
+      for (s32 dx = -extent; dx <= extent; dx++)
+      {
+        f32 distance = static_cast<f32>(dx * dx + dy * dy) / (radius * radius);
+        if (distance > 1.0f)
+          continue;
+
+        u32 x = Wrap(static_cast<s32>(center_x) + dx, static_cast<s32>(width));
+        f32 value = CellValue(config, stream, x, y, width, binary, 0.5f);
+        if (!binary)
+          value *= 1.0f - distance;
+
+        f32 &cell = cells[static_cast<size_t>(y - first_row) * stride + x];
+        cell = std::max(cell, value);
+      }
+    }
+  }
+}
+
+static void FillRows(const SeedConfig &config, u32 width, u32 height, boolean binary, f32 *cells, u32 stream, u32 stride,
+                     u32 first_row, u32 last_row)
+{
+  switch (config.pattern_)
+  {
+  case SeedPattern::Noise:
+    FillNoise(config, width, binary, cells, stream, stride, first_row, last_row);
+    break;
+  case SeedPattern::Blobs:
+    FillBlobs(config, width, height, binary, cells, stream, stride, first_row, last_row);
+    break;
+  case SeedPattern::Soup:
+    FillSoup(config, width, binary, cells, stream, stride, first_row, last_row);
+    break;
+  }
+}
+///////////////////////////////////////////////////////////////////////////////
+
+void Seeder::Fill(const SeedConfig &config, u32 width, u32 height, boolean binary, f32 *cells, u32 stream, u32 stride)
+{
+  if (!cells || width == 0 || height == 0)
+    return;
+
+  if (stride == 0)
+    stride = width;
+
+  ParallelFor(height, [&](u32 first_row, u32 last_row)
+              {
+    FillRows(config, width, height, binary, cells + static_cast<size_t>(first_row) * stride, stream, stride, first_row, last_row); });
+}
+
+void Seeder::FillBits(const SeedConfig &config, u32 width, u32 height, u32 *words, u32 stream)
+{
+  if (!words || width == 0 || height == 0)
+    return;
+
+  u32 row_words = (width + 31) / 32;
+
+  ParallelFor(height, [&](u32 first_row, u32 last_row)
+              {
+    std::vector<f32> chunk(static_cast<size_t>(SEED_BITS_ROWS) * width);
+
+    for (u32 first = first_row; first < last_row; first += SEED_BITS_ROWS)
+    {
+      u32 last = std::min(first + SEED_BITS_ROWS, last_row);
+      FillRows(config, width, height, true, chunk.data(), stream, width, first, last);
+
+      for (u32 y = first; y < last; y++)
+      {
+        const f32 *row = chunk.data() + static_cast<size_t>(y - first) * width;
+        u32 *row_bits = words + static_cast<size_t>(y) * row_words;
+        std::fill(row_bits, row_bits + row_words, 0u);
+
+        for (u32 x = 0; x < width; x++)
+          if (row[x] > 0.5f)
+            row_bits[x / 32] |= 1u << (x % 32);
+      }
+    } }, SEED_BITS_ROWS);
+}
+
+void Seeder::FillBytes(const SeedConfig &config, u32 width, u32 height, u_byte *cells, u32 stream)
+{
+  if (!cells || width == 0 || height == 0)
+    return;
+
+  ParallelFor(height, [&](u32 first_row, u32 last_row)
+              {
+    std::vector<f32> chunk(static_cast<size_t>(SEED_BITS_ROWS) * width);
+
+    for (u32 first = first_row; first < last_row; first += SEED_BITS_ROWS)
+    {
+      u32 last = std::min(first + SEED_BITS_ROWS, last_row);
+      FillRows(config, width, height, true, chunk.data(), stream, width, first, last);
+
+      u_byte *bytes = cells + static_cast<size_t>(first) * width;
+      for (size_t i = 0; i < static_cast<size_t>(last - first) * width; i++)
+        bytes[i] = (chunk[i] > 0.5f) ? 255 : 0;
+    } }, SEED_BITS_ROWS);
+}
+
+boolean Seeder::Imgui(SeedConfig &config)
+{
+  ImGui::Separator();
+
+  s32 seed = static_cast<s32>(config.seed_);
+  if (ImGui::InputInt("Seed", &seed))
+    config.seed_ = static_cast<u32>(seed);
+
+  s32 pattern = static_cast<s32>(config.pattern_);
+  if (ImGui::Combo("Pattern", &pattern, pattern_names, 3))
+    config.pattern_ = static_cast<SeedPattern>(pattern);
+
+  ImGui::SliderFloat("Density", &config.density_, 0.0f, 1.0f);
+  if (config.pattern_ != SeedPattern::Noise)
+    ImGui::SliderFloat("Scale", &config.scale_, 2.0f, 64.0f);
+
+  return ImGui::Button("Reset");
+}
+
+const byte *Seeder::PatternName(SeedPattern pattern)
+{
+  return pattern_names[static_cast<s32>(pattern)];
+}
+
+boolean Seeder::ParsePattern(const byte *name, SeedPattern &pattern)
+{
+  for (s32 i = 0; i < 3; i++)
+  {
+    if (strcmp(name, pattern_names[i]) == 0)
+    {
+      pattern = static_cast<SeedPattern>(i);
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -1,49 +1,62 @@
 #include "ia/smooth_life.h"
 #include "ia/gpu_helper.h"
+#include "ia/program_batch.h"
 #include "ia/defines.h"
 
 void CheckComputeResults(GLuint counter_ssbo, GLuint prev_data_id, u32 width, u32 height)
 {
   // Use glGetNamedBufferSubData to retrieve data from the buffer for debugging
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
   Counter *data = reinterpret_cast<Counter *>(std::calloc(width * height, sizeof(Counter)));
   glGetNamedBufferSubData(counter_ssbo, 0, width * height * sizeof(Counter), data);
 
   // Use glGetTexImage to retrieve data from the image for debugging
-  u_byte *prev_image_data = reinterpret_cast<u_byte *>(std::calloc(width * height * 4, sizeof(u_byte)));
-  glBindTexture(GL_TEXTURE_2D, prev_data_id);
-  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, prev_image_data);
+  u_byte *prev_image_data = reinterpret_cast<u_byte *>(std::calloc(width * height, sizeof(u_byte)));
+  GPUHelper::DownloadState(prev_data_id, GL_UNSIGNED_BYTE, prev_image_data);
 
   DESTROY(data);
   DESTROY(prev_image_data);
 }
 
-SmoothLife::SmoothLife() {}
+SmoothLife::SmoothLife()
+{
+  summed_area_ = false;
+  level_count_ = 0;
+  levels_radius_ = 0.0f;
+
+  loops_ = 0;
+  pre_compute_program_ = 0;
+  compute_program_ = 0;
+  column_program_ = 0;
+  summed_area_program_ = 0;
+  width_ = 0;
+  height_ = 0;
+  counter_ssbo_ = 0;
+  table_ssbo_ = 0;
+  prev_data_id_ = 0;
+  current_data_id_ = 0;
+
+  counter_section_ = profiler_.addSection("Counter");
+  column_section_ = profiler_.addSection("Column scan");
+  automata_section_ = profiler_.addSection("Automata");
+}
 
 void SmoothLife::init(Math::Vec2 win)
 {
   loops_ = 0;
   width_ = static_cast<u32>(win.x);
   height_ = static_cast<u32>(win.y);
-  outter_rad_ = O_RADIUS;
+  radius_ = O_RADIUS;
   inner_rad_ = I_RADIUS;
-  depth_ = C_DEPTH;
 
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
+  current_data_id_ = GPUHelper::CreateStateTexture(width_, height_, BINARY_STATE_FORMAT);
+  prev_data_id_ = GPUHelper::CreateStateTexture(width_, height_, BINARY_STATE_FORMAT);
 
-  if (!data)
-  {
-    width_ = 0;
-    height_ = 0;
+  color_map_.init(width_, height_);
 
-    return;
-  }
-
-  current_data_id_ = GPUHelper::CreateTexture(width_, height_, data);
-  prev_data_id_ = GPUHelper::CreateTexture(width_, height_, data);
-
-  DESTROY(data);
-
-  compileShaders();
+  // Without its programs the engine doesn't step, F5 builds them again
+  if (!compileShaders() && !ready())
+    fprintf(stderr, "SmoothLife can't step, its programs didn't build\n");
 
   glUseProgram(compute_program_);
 
@@ -54,83 +67,88 @@ void SmoothLife::init(Math::Vec2 win)
   glBufferData(GL_SHADER_STORAGE_BUFFER, width_ * height_ * sizeof(Counter), nullptr, GL_DYNAMIC_COPY);
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNTER_BIND, counter_ssbo_);
   glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  glUseProgram(0);
   /////////////////////////////////////////////////////////////////////////////
 
-  // Counter indices
-  /////////////////////////////////////////////////////////////////////////////
-  Math::Vec2 *indices = reinterpret_cast<Math::Vec2 *>(std::calloc(width_ * height_ * depth_, sizeof(Math::Vec2)));
+  reset();
+}
 
-  Math::Vec2 coords[static_cast<u32>(NEAR_NEIGHBORS)] = {
-      Math::Vec2(-1.0f, -1.0f), Math::Vec2(+1.0f, -1.0f),
-      Math::Vec2(-1.0f, +0.0f), Math::Vec2(+1.0f, +0.0f),
-      Math::Vec2(-1.0f, +1.0f), Math::Vec2(+1.0f, +1.0f)};
+SmoothLife::~SmoothLife()
+{
+  if (pre_compute_program_ != 0)
+    glDeleteProgram(pre_compute_program_);
+  if (compute_program_ != 0)
+    glDeleteProgram(compute_program_);
+  if (column_program_ != 0)
+    glDeleteProgram(column_program_);
+  if (summed_area_program_ != 0)
+    glDeleteProgram(summed_area_program_);
+
+  if (counter_ssbo_ != 0)
+    glDeleteBuffers(1, &counter_ssbo_);
+  if (table_ssbo_ != 0)
+    glDeleteBuffers(1, &table_ssbo_);
+
+  if (prev_data_id_ != 0)
+    glDeleteTextures(1, &prev_data_id_);
+  if (current_data_id_ != 0)
+    glDeleteTextures(1, &current_data_id_);
+}
 
-  for (s32 col = 0; col < static_cast<s32>(width_); col++)
+void SmoothLife::swap()
+{
+  std::swap(current_data_id_, prev_data_id_);
+}
+
+// Maximal centered rectangles of the disk, a staircase of them covers it exactly
+static std::vector<s32> DiskCorners(f32 radius)
+{
+  std::vector<s32> corners;
+  s32 rows = static_cast<s32>(radius);
+  for (s32 y = 0; y <= rows; y++)
   {
-    for (s32 row = 0; row < static_cast<s32>(height_); row++)
+    s32 width = static_cast<s32>(std::floor(sqrtf((radius * radius) - static_cast<f32>(y * y))));
+    s32 next_width = (y < rows) ? static_cast<s32>(std::floor(sqrtf((radius * radius) - static_cast<f32>((y + 1) * (y + 1))))) : -1;
+
+    if (next_width < width)
     {
-      f32 y = -O_RADIUS;
-      for (s32 depth = 0; depth < static_cast<s32>(depth_); depth += 2)
-      {
-        u32 index = ARRAY_3D_INDEX(col, row, depth, height_, depth_);
-
-        Math::Vec2 start_coord;
-        Math::Vec2 end_coord;
-
-        if (depth < static_cast<s32>(NEAR_NEIGHBORS))
-        {
-          start_coord = coords[depth] + Math::Vec2(static_cast<f32>(col), static_cast<f32>(row));
-          end_coord = coords[depth + 1] + Math::Vec2(static_cast<f32>(col), static_cast<f32>(row));
-        }
-        else
-        {
-          f32 x_offset = std::floor(sqrtf((outter_rad_ * outter_rad_) - (y * y)));
-          start_coord = Math::Vec2(static_cast<f32>(col) - x_offset - 1.0f, static_cast<f32>(row) + y);
-          end_coord = Math::Vec2(static_cast<f32>(col) + x_offset, static_cast<f32>(row) + y);
-          y++;
-        }
-
-        start_coord.x = std::max(start_coord.x, 0.0f);
-        start_coord.x = std::min(start_coord.x, static_cast<f32>(width_) - 1.0f);
-
-        start_coord.y = std::max(start_coord.y, 0.0f);
-        start_coord.y = std::min(start_coord.y, static_cast<f32>(height_) - 1.0f);
-
-        end_coord.x = std::max(end_coord.x, 0.0f);
-        end_coord.x = std::min(end_coord.x, static_cast<f32>(width_) - 1.0f);
-
-        end_coord.y = std::max(end_coord.y, 0.0f);
-        end_coord.y = std::min(end_coord.y, static_cast<f32>(height_) - 1.0f);
-
-        indices[index] = start_coord;
-        indices[index + 1] = end_coord;
-      }
+      corners.push_back(width);
+      corners.push_back(y);
     }
   }
 
-  glGenBuffers(1, &counter_indices_ssbo_);
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, counter_indices_ssbo_);
-  glBufferData(GL_SHADER_STORAGE_BUFFER, width_ * height_ * depth_ * sizeof(Math::Vec2), indices, GL_STATIC_COPY);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INDICES_BIND, counter_indices_ssbo_);
-
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-  glUseProgram(0);
-
-  DESTROY(indices);
-  /////////////////////////////////////////////////////////////////////////////
-
-  reset();
+  return corners;
 }
 
-SmoothLife::~SmoothLife() {}
+boolean SmoothLife::TableFits(f32 radius)
+{
+  return DiskCorners(radius).size() / 2 <= SUMMED_AREA_LEVELS;
+}
 
-void SmoothLife::swap()
+// False when the radius doesn't fit, the table would only step an inscribed polygon
+boolean SmoothLife::buildLevels()
 {
-  std::swap(current_data_id_, prev_data_id_);
+  if (levels_radius_ == radius_ && level_count_ > 0)
+    return true;
+
+  std::vector<s32> corners = DiskCorners(radius_);
+  if (corners.size() / 2 > SUMMED_AREA_LEVELS)
+  {
+    level_count_ = 0;
+    return false;
+  }
+
+  level_count_ = static_cast<s32>(corners.size() / 2);
+  std::copy(corners.begin(), corners.end(), levels_);
+  levels_radius_ = radius_;
+  return true;
 }
 
 void SmoothLife::update()
 {
+  if (!ready())
+    return;
+
   update_timer_.startTime();
   loops_++;
 
@@ -142,41 +160,85 @@ void SmoothLife::update()
   glUseProgram(pre_compute_program_);
 
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNTER_BIND, counter_ssbo_);
-  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
-  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, BINARY_STATE_FORMAT);
+  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, BINARY_STATE_FORMAT);
 
   // Dispatch Compute Shader with appropriate workgroup sizes
+  profiler_.begin(counter_section_);
   glDispatchCompute(1, height_, 1);
+  profiler_.end();
   error = glGetError();
   if (error != GL_NO_ERROR)
     fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
 
-  glMemoryBarrier(GL_ALL_BARRIER_BITS);
+  glMemoryBarrier(STEP_BARRIER_BITS);
   // CheckComputeResults(counter_ssbo_, prev_data_id_, width_, height_);
   glUseProgram(0);
   /////////////////////////////////////////////////////////////////////////////
 
+  // GPU Column scan
+  /////////////////////////////////////////////////////////////////////////////
+  // Spans step the same disk when the table programs didn't build
+  boolean summed_area = summed_area_ && column_program_ != 0 && summed_area_program_ != 0 && buildLevels();
+  if (summed_area)
+  {
+    if (table_ssbo_ == 0)
+    {
+      glGenBuffers(1, &table_ssbo_);
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, table_ssbo_);
+      glBufferData(GL_SHADER_STORAGE_BUFFER, width_ * height_ * sizeof(u32), nullptr, GL_DYNAMIC_COPY);
+      glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    glUseProgram(column_program_);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNTER_BIND, counter_ssbo_);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TABLE_BIND, table_ssbo_);
+
+    profiler_.begin(column_section_);
+    glDispatchCompute(DISPATCH_GROUPS(width_, SCAN_THREADS), 1, 1);
+    profiler_.end();
+    error = glGetError();
+    if (error != GL_NO_ERROR)
+      fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
+
+    glMemoryBarrier(STEP_BARRIER_BITS);
+    glUseProgram(0);
+  }
+  /////////////////////////////////////////////////////////////////////////////
+
   // GPU Automata
   /////////////////////////////////////////////////////////////////////////////
-  glUseProgram(compute_program_);
+  u32 program = summed_area ? summed_area_program_ : compute_program_;
+  glUseProgram(program);
 
   glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNTER_BIND, counter_ssbo_);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INDICES_BIND, counter_indices_ssbo_);
-  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
-  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+  glBindImageTexture(CURR_IMG_BIND, current_data_id_, 0, GL_FALSE, 0, GL_WRITE_ONLY, BINARY_STATE_FORMAT);
+  glBindImageTexture(PREV_IMG_BIND, prev_data_id_, 0, GL_FALSE, 0, GL_READ_ONLY, BINARY_STATE_FORMAT);
+
+  AutomataParams params = {};
+  params.radius_ = radius_;
+  if (summed_area)
+  {
+    params.level_count_ = level_count_;
+    std::memcpy(params.levels_, levels_, sizeof(s32) * 2 * static_cast<size_t>(level_count_));
+  }
+  param_block_.bind(PARAMS_BIND, params);
 
   // Dispatch Compute Shader with appropriate workgroup sizes
-  glDispatchCompute(width_ / X_THREADS, height_ / Y_THREADS, 1);
+  profiler_.begin(automata_section_);
+  glDispatchCompute(DISPATCH_GROUPS(width_, X_THREADS), DISPATCH_GROUPS(height_, Y_THREADS), 1);
+  profiler_.end();
   error = glGetError();
   if (error != GL_NO_ERROR)
     fprintf(stderr, "Compute Shader Dispatch Error: %d\n", error);
 
-  glMemoryBarrier(GL_ALL_BARRIER_BITS);
+  glMemoryBarrier(STEP_BARRIER_BITS);
 
   glUseProgram(0);
   /////////////////////////////////////////////////////////////////////////////
 
-  glFinish();
+  profiler_.frame();
   update_timer_.stopTime();
 }
 
@@ -185,10 +247,19 @@ void SmoothLife::imgui()
   ImGui::Begin("GPU Automata");
 
   ImGui::Text("Type - Smooth life");
-  ImGui::Text("Update time: %ld mcs", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
+  ImGui::Text("CPU time: %ld mcs", update_timer_.getElapsedTime(TimeCont::Precision::microseconds));
   ImGui::Text("Generation: %d", loops_);
+  profiler_.imgui();
 
-  ImGui::Text("Radius: %.1f", O_RADIUS);
+  ImGui::SliderFloat("Radius", &radius_, 4.0f, 32.0f);
+  ImGui::Checkbox("Summed area table", &summed_area_);
+  if (summed_area_ && level_count_ > 0)
+    ImGui::Text("Rectangles: %d", level_count_ * 2 - 1);
+  else if (summed_area_)
+    ImGui::Text("Radius over the table, stepped with spans");
+
+  if (Seeder::Imgui(seed_))
+    reset();
 
   ImGui::End();
 }
@@ -196,71 +267,70 @@ void SmoothLife::imgui()
 void SmoothLife::reset()
 {
   loops_ = 0;
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
+  // One byte per cell like the R8 state, a quarter of the float staging
+  u_byte *data = reinterpret_cast<u_byte *>(staging_.map(static_cast<size_t>(width_) * height_));
 
   if (!data)
     return;
 
-  u_byte alive = 255;
-  u_byte dead = 0;
-
-  for (u32 i = 0; i < width_ * height_ * 4; i += 4)
-  {
-    data[i + 0] = alive;
-    data[i + 1] = alive;
-    data[i + 2] = alive;
-
-    data[i + 3] = (rand() % 5 < 2) ? alive : dead;
-  }
+  Seeder::FillBytes(seed_, width_, height_, data);
 
-  glBindTexture(GL_TEXTURE_2D, current_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-  glBindTexture(GL_TEXTURE_2D, prev_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-
-  DESTROY(data);
+  staging_.upload(current_data_id_, width_, height_, GL_UNSIGNED_BYTE);
+  GPUHelper::CopyState(current_data_id_, prev_data_id_, width_, height_);
 }
 
 void SmoothLife::clean()
 {
-  u_byte *data = reinterpret_cast<u_byte *>(std::calloc(width_ * height_ * 4, sizeof(u_byte)));
-
-  if (!data)
-    return;
-
-  glBindTexture(GL_TEXTURE_2D, current_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+  GPUHelper::ClearState(current_data_id_);
+  GPUHelper::ClearState(prev_data_id_);
+}
 
-  glBindTexture(GL_TEXTURE_2D, prev_data_id_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+u32 SmoothLife::currentTexture() { return color_map_.apply(current_data_id_); }
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+u64 SmoothLife::memoryUsage() const
+{
+  u64 cells = static_cast<u64>(width_) * height_;
+  u64 table = (table_ssbo_ != 0) ? cells * sizeof(u32) : 0;
+  return cells * (2 + sizeof(Counter)) + table + staging_.size() + color_map_.memoryUsage();
+}
 
-  DESTROY(data);
+void SmoothLife::setCells(const f32 *cells)
+{
+  GPUHelper::UploadState(current_data_id_, width_, height_, GL_FLOAT, cells);
+  GPUHelper::UploadState(prev_data_id_, width_, height_, GL_FLOAT, cells);
 }
 
-u32 SmoothLife::currentTexture() { return current_data_id_; }
+void SmoothLife::getCells(f32 *cells) { GPUHelper::DownloadState(current_data_id_, GL_FLOAT, cells); }
 
-void SmoothLife::compileShaders()
+boolean SmoothLife::ready() const { return pre_compute_program_ != 0 && compute_program_ != 0; }
+
+boolean SmoothLife::compileShaders()
 {
+  ProgramBatch batch;
+
   // Pre Compute shader
   /////////////////////////////////////////////////////////////////////////////
-  std::string pre_compute = defines + LoadSourceFromFile(SHADER("ia/smooth/counter_cs.glsl"));
-  const char *pre_compute_cs = pre_compute.c_str();
+  std::string scan = LoadSourceFromFile(SHADER("ia/smooth/scan.glsl"));
+  std::string pre_compute = defines + GPUHelper::GridDefines(width_, height_) + scan + LoadSourceFromFile(SHADER("ia/smooth/counter_cs.glsl"));
 
-  GLuint pre_compute_shader = GPUHelper::CompileShader(GL_COMPUTE_SHADER, pre_compute_cs, "pre smooth shader");
-  pre_compute_program_ = GPUHelper::CreateProgram(pre_compute_shader, "pre smooth program");
+  batch.add(&pre_compute_program_, pre_compute, "pre smooth program");
   /////////////////////////////////////////////////////////////////////////////
 
   // Compute shader
   /////////////////////////////////////////////////////////////////////////////
-  std::string smooth_string = defines + LoadSourceFromFile(SHADER("ia/smooth/smooth_cs.glsl"));
-  const char *smooth_cs = smooth_string.c_str();
+  std::string smooth_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/smooth/smooth_cs.glsl"));
 
-  GLuint compute_shader = GPUHelper::CompileShader(GL_COMPUTE_SHADER, smooth_cs, "smooth shader");
-  compute_program_ = GPUHelper::CreateProgram(compute_shader, "smoot program");
+  batch.add(&compute_program_, smooth_string, "smoot program");
   /////////////////////////////////////////////////////////////////////////////
+
+  // Summed area table shaders
+  /////////////////////////////////////////////////////////////////////////////
+  std::string column_string = defines + GPUHelper::GridDefines(width_, height_) + LoadSourceFromFile(SHADER("ia/smooth/column_scan_cs.glsl"));
+  batch.add(&column_program_, column_string, "column scan program");
+
+  std::string summed_area_string = defines + GPUHelper::GridDefines(width_, height_) + "#define SUMMED_AREA\n" + LoadSourceFromFile(SHADER("ia/smooth/smooth_cs.glsl"));
+  batch.add(&summed_area_program_, summed_area_string, "summed area smooth program");
+  /////////////////////////////////////////////////////////////////////////////
+
+  return batch.finish();
 }
@@ -0,0 +1,92 @@
+#include "ia/staging_buffer.h"
+
+StagingBuffer::StagingBuffer()
+{
+  pbo_ = 0;
+  size_ = 0;
+  memory_ = nullptr;
+  fence_ = nullptr;
+}
+
+StagingBuffer::~StagingBuffer()
+{
+  if (fence_)
+    glDeleteSync(fence_);
+  if (pbo_ != 0)
+    glDeleteBuffers(1, &pbo_);
+}
+
+void StagingBuffer::wait()
+{
+  if (!fence_)
+    return;
+
+  glClientWaitSync(fence_, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+  glDeleteSync(fence_);
+  fence_ = nullptr;
+}
+
+void *StagingBuffer::map(size_t size)
+{
+  wait();
+
+  if (size <= size_)
+    return memory_;
+
+  // Immutable storage can't grow, a bigger buffer replaces it
+  if (pbo_ != 0)
+    glDeleteBuffers(1, &pbo_);
+
+  GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  glGenBuffers(1, &pbo_);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_);
+  glBufferStorage(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, flags);
+  memory_ = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size), flags);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  size_ = memory_ ? size : 0;
+  if (!memory_)
+    fprintf(stderr, "Error mapping a staging buffer of %zu bytes\n", size);
+
+  return memory_;
+}
+
+size_t StagingBuffer::size() const
+{
+  return size_;
+}
+
+void StagingBuffer::upload(u32 texture, u32 width, u32 height, u32 type)
+{
+  glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_);
+
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, type, nullptr);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  if (fence_)
+    glDeleteSync(fence_);
+  fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StagingBuffer::copy(u32 buffer, size_t size)
+{
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+  glBindBuffer(GL_COPY_READ_BUFFER, pbo_);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(size));
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+  if (fence_)
+    glDeleteSync(fence_);
+  fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -1,5 +1,8 @@
 #include <engine/jam_engine.h>
 #include "ia/ia.h"
+#include "ia/program_batch.h"
+#include "ia/param_block.h"
+#include "ia/backends.h"
 
 static f32 win_x = C_WIDTH * SCALAR_SIZE;
 static f32 win_y = C_HEIGHT * SCALAR_SIZE;
@@ -26,12 +29,126 @@ static Camera camera;
 static Mesh *quad = nullptr;
 static Material *img = nullptr;
 
-const static s32 max_modes = 3;
+const static s32 max_modes = 8;
 static s32 mode = 0;
-static Conway conway;
-static SmoothLife smooth_life;
-static Lenia lenia;
-static LeniaOp lenia_op;
+
+// The first modes run the fastest backend of their rule, measured once per machine
+const static s32 rule_modes = 3;
+static const Rule mode_rules[rule_modes] = {Rule::Conway, Rule::SmoothLife, Rule::Lenia};
+const static s32 hashlife_mode = 5;
+
+// Engines are made the first time their mode is shown, the ones left behind stay
+// resident until the budget is passed and then are released oldest first
+struct ModeSlot
+{
+  std::unique_ptr<Automata> engine_;
+  const BackendInfo *backend_ = nullptr;
+  s32 last_frame_ = -1;
+};
+static ModeSlot slots[max_modes + 1];
+
+// Backend changes wait until the frame that still draws the old engine ends
+static const BackendInfo *next_backend = nullptr;
+static boolean calibrate = false;
+static s32 resident_budget_mb = 1024;
+static s32 frames = -1;
+
+// Mode whose last F5 didn't build every program, -1 when it did
+static s32 failed_rebuild_mode = -1;
+
+// Generations per rendered frame, only the last one is drawn
+const static s32 max_steps_per_frame = 4096;
+const static s32 max_manual_steps = 64;
+const static size_t steps_budget_mcs = 12000;
+static s32 steps_per_frame = 1;
+static boolean unlimited_steps = false;
+static TimeCont steps_timer;
+static GLsync steps_fence = nullptr;
+
+template <typename T>
+static std::unique_ptr<T> Create(Math::Vec2 size)
+{
+  std::unique_ptr<T> engine = std::make_unique<T>();
+  engine->init(size);
+  return engine;
+}
+
+static std::unique_ptr<Automata> CreateEngine(s32 engine_mode)
+{
+  Math::Vec2 size(C_WIDTH, C_HEIGHT);
+
+  if (engine_mode < rule_modes)
+  {
+    ModeSlot &slot = slots[engine_mode];
+    if (!slot.backend_)
+      slot.backend_ = Backends::Select(mode_rules[engine_mode], C_WIDTH, C_HEIGHT, RuleParams(), true);
+    return Backends::Create(*slot.backend_, C_WIDTH, C_HEIGHT, RuleParams());
+  }
+
+  switch (engine_mode)
+  {
+  case 3:
+    return Create<LeniaOp>(size);
+  case 4:
+    return Create<ConwayCPU>(size);
+  case hashlife_mode:
+    return Create<Hashlife>(size);
+  case 6:
+  {
+    std::unique_ptr<LeniaFFT> engine = Create<LeniaFFT>(size);
+    engine->backend_ = FFT_BACKEND_GPU;
+    return engine;
+  }
+  case 7:
+  {
+    std::unique_ptr<LeniaMulti> engine = Create<LeniaMulti>(size);
+    engine->backend_ = FFT_BACKEND_GPU;
+    return engine;
+  }
+  default:
+    return Create<LeniaEnsemble>(Math::Vec2(C_WIDTH / 8, C_HEIGHT / 8));
+  }
+}
+
+static Automata &Acquire()
+{
+  ModeSlot &slot = slots[mode];
+  if (!slot.engine_)
+    slot.engine_ = CreateEngine(mode);
+
+  slot.last_frame_ = frames;
+  return *slot.engine_;
+}
+
+static u64 ResidentMemory()
+{
+  u64 resident = 0;
+  for (const ModeSlot &slot : slots)
+    if (slot.engine_)
+      resident += slot.engine_->memoryUsage();
+
+  return resident;
+}
+
+// The current mode is never released
+static void ReleaseEngines(u64 budget)
+{
+  while (ResidentMemory() > budget)
+  {
+    s32 oldest = -1;
+    for (s32 i = 0; i <= max_modes; i++)
+      if (i != mode && slots[i].engine_ && (oldest < 0 || slots[i].last_frame_ < slots[oldest].last_frame_))
+        oldest = i;
+
+    if (oldest < 0)
+      return;
+
+    // The backend choice stays
+    fprintf(stdout, "Releasing mode %d\n", oldest);
+    slots[oldest].engine_.reset();
+    slots[oldest].last_frame_ = -1;
+  }
+}
 
 void ChangeMode(s32 &mode, s32 signess, s32 min, s32 max)
 {
@@ -56,12 +173,6 @@ void UserInit(s32 argc, byte *argv[], void *)
   // Mesh
   quad = JAM_Engine::GetMesh(Mesh::Platonic::k_Quad);
 
-  // GPU Automata
-  conway.init(Math::Vec2(C_WIDTH, C_HEIGHT));
-  smooth_life.init(Math::Vec2(C_WIDTH, C_HEIGHT));
-  lenia.init(Math::Vec2(C_WIDTH, C_HEIGHT));
-  lenia_op.init(Math::Vec2(C_WIDTH, C_HEIGHT));
-
   Transform tr;
   tr.scale(Math::Vec3(1.0f));
   tr.rotate(Math::Vec3(Math::MathUtils::AngleToRads(90.0f), 0.0f, 0.0f));
@@ -71,43 +182,111 @@ void UserInit(s32 argc, byte *argv[], void *)
   EM->setComponent(EM->getId("Quad"), tr);
 }
 
-static s32 frames = -1;
+static void Step(Automata &engine)
+{
+  steps_timer.startTime();
+  for (s32 step = 0; step < steps_per_frame; step++)
+    engine.update();
+  steps_timer.stopTime();
 
-void UserUpdate(void *)
+  steps_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+static u32 Show(Automata &engine)
 {
-  frames++;
+  Step(engine);
+  engine.imgui();
+  return engine.currentTexture();
+}
 
-  u32 texture_id = (u32)(-1);
-  if (mode == 0)
-  {
-    conway.update();
-    conway.imgui();
-    texture_id = conway.currentTexture();
-  }
+// Unlimited mode grows the steps while the GPU finishes them before the next frame
+static void AdaptSteps()
+{
+  if (!steps_fence)
+    return;
+
+  GLenum status = glClientWaitSync(steps_fence, 0, 0);
+  boolean gpu_done = status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+  glDeleteSync(steps_fence);
+  steps_fence = nullptr;
+
+  if (!unlimited_steps)
+    return;
 
-  if (mode == 1)
+  // CPU engines are done when update returns, their time is in the timer
+  boolean cpu_done = steps_timer.getElapsedTime(TimeCont::Precision::microseconds) < steps_budget_mcs;
+
+  if (gpu_done && cpu_done)
+    steps_per_frame = std::min(steps_per_frame + std::max(steps_per_frame / 8, 1), max_steps_per_frame);
+  else
+    steps_per_frame = std::max((steps_per_frame * 3) / 4, 1);
+}
+
+static void SimulationImgui()
+{
+  ImGui::Begin("Simulation");
+
+  ImGui::Checkbox("Unlimited", &unlimited_steps);
+  if (unlimited_steps)
   {
-    smooth_life.update();
-    smooth_life.imgui();
-    texture_id = smooth_life.currentTexture();
+    ImGui::Text("Steps per frame: %d", steps_per_frame);
   }
-
-  if (mode == 2)
+  else
   {
-    lenia.update();
-    lenia.imgui();
-    texture_id = lenia.currentTexture();
+    steps_per_frame = std::min(steps_per_frame, max_manual_steps);
+    ImGui::SliderInt("Steps per frame", &steps_per_frame, 1, max_manual_steps);
   }
 
-  if (mode == 3)
+  ImGui::Text("Programs: %u cached, %u compiled", ProgramBatch::CacheHits(), ProgramBatch::CacheMisses());
+
+  ModeSlot &slot = slots[mode];
+  if (slot.engine_ && !slot.engine_->ready())
+    ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Programs didn't build, it won't step until F5 builds them");
+  else if (failed_rebuild_mode == mode)
+    ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "F5 rebuild failed, the old programs keep running");
+  ImGui::Text("Parameter uploads: %u", ParamBlock::Uploads());
+  ImGui::Text("Resident memory: %.1f MB", static_cast<f64>(ResidentMemory()) / (1024.0 * 1024.0));
+  ImGui::SliderInt("Budget (MB)", &resident_budget_mb, 0, 8192);
+
+  if (mode < rule_modes && slot.backend_)
   {
-    lenia_op.update();
-    lenia_op.imgui();
-    texture_id = lenia_op.currentTexture();
+    ImGui::Separator();
+
+    std::vector<const BackendInfo *> list = Backends::List(mode_rules[mode], C_WIDTH, C_HEIGHT, Backends::Radius(mode_rules[mode], RuleParams()), true);
+    std::vector<const byte *> names;
+    s32 current = 0;
+    for (const BackendInfo *backend : list)
+    {
+      if (backend == slot.backend_)
+        current = static_cast<s32>(names.size());
+      names.push_back(backend->name_);
+    }
+
+    if (ImGui::Combo("Backend", &current, names.data(), static_cast<s32>(names.size())))
+      next_backend = list[current];
+    if (ImGui::Button("Calibrate"))
+      calibrate = true;
   }
 
+  ImGui::End();
+}
+
+void UserUpdate(void *)
+{
+  frames++;
+  AdaptSteps();
+
+  Automata &engine = Acquire();
+  u32 texture_id = Show(engine);
+
+  SimulationImgui();
+
+  // A program that doesn't build prints its log and the old one keeps running, the panel says so
   if (JAM_Engine::InputDown(Inputs::Key::Key_F5))
+  {
     JAM_Engine::RechargeShaders();
+    failed_rebuild_mode = engine.compileShaders() ? -1 : mode;
+  }
 
   JAM_Engine::BeginRender(&camera);
 
@@ -118,24 +297,38 @@ void UserUpdate(void *)
   JAM_Engine::EndRender();
 
   if (JAM_Engine::InputDown(Inputs::Key::Key_R))
+    engine.reset();
+
+  // Continue the Conway grid with Hashlife
+  if (mode == hashlife_mode && slots[0].engine_ && JAM_Engine::InputDown(Inputs::Key::Key_I))
+    static_cast<Hashlife &>(engine).loadTexture(slots[0].engine_->currentTexture());
+
+  // The new engine starts from its reset() state
+  if (next_backend || calibrate)
   {
-    if (mode == 0)
-      conway.reset();
-    if (mode == 1)
-      smooth_life.reset();
-    if (mode == 2)
-      lenia.reset();
-    if (mode == 3)
-      lenia_op.reset();
+    ModeSlot &slot = slots[mode];
+    slot.engine_.reset();
+    if (failed_rebuild_mode == mode)
+      failed_rebuild_mode = -1;
+    slot.backend_ = calibrate ? Backends::Calibrate(mode_rules[mode], C_WIDTH, C_HEIGHT, RuleParams(), true) : next_backend;
+    next_backend = nullptr;
+    calibrate = false;
   }
 
   if (JAM_Engine::InputDown(Inputs::Key::Key_Left))
     ChangeMode(mode, -1, 0, max_modes);
   if (JAM_Engine::InputDown(Inputs::Key::Key_Right))
     ChangeMode(mode, 1, 0, max_modes);
+
+  ReleaseEngines(static_cast<u64>(resident_budget_mb) << 20);
 }
 
-void UserClean(void *) {}
+// GL objects have to go before the context
+void UserClean(void *)
+{
+  for (ModeSlot &slot : slots)
+    slot.engine_.reset();
+}
 
 s32 main(s32 argc, byte *argv[])
 {
@@ -108,6 +108,49 @@ files {
   "../include/**",
   "../src/**",
 }
+removefiles { "../src/headless/**", "../src/conformance/**" }
 filter "files:**.obj"
     flags { "ExcludeFromBuild" }
 -------------------------------------------------------------------------------
+
+-- Headless
+-------------------------------------------------------------------------------
+project "Headless"
+
+kind "ConsoleApp"
+language "C++"
+targetdir "../build/%{prj.name}/%{cfg.buildcfg}"
+includedirs { "../include", "../deps/include" }
+filter "configurations:Debug"
+  links {"../deps/libs/jam_engine/JAM_Engine_x64_d.lib"}
+filter "configurations:Release"
+  links {"../deps/libs/jam_engine/JAM_Engine_x64.lib"}
+conan_config_exec()
+files {
+  "../deps/include/**",
+  "../include/**",
+  "../src/**",
+}
+removefiles { "../src/main.cpp", "../src/conformance/**" }
+-------------------------------------------------------------------------------
+
+-- Conformance
+-------------------------------------------------------------------------------
+project "Conformance"
+
+kind "ConsoleApp"
+language "C++"
+targetdir "../build/%{prj.name}/%{cfg.buildcfg}"
+includedirs { "../include", "../deps/include" }
+filter "configurations:Debug"
+  links {"../deps/libs/jam_engine/JAM_Engine_x64_d.lib"}
+filter "configurations:Release"
+  links {"../deps/libs/jam_engine/JAM_Engine_x64.lib"}
+conan_config_exec()
+files {
+  "../deps/include/**",
+  "../include/**",
+  "../src/**",
+}
+removefiles { "../src/main.cpp", "../src/headless/headless.cpp" }
+-------------------------------------------------------------------------------